@@ -6,22 +6,21 @@
 #include <Arduino.h>
 #include "ControllerInput.h"
 #include "Tetris.h"
+#include "TetrisBot.h"
 #include "Pong.h"
 #include "Snake.h"
+#include "SnakeBot.h"
 #include "Chess.h"
 #include "Scores.h" // Include Scores.h
+#include "Storage.h"
+#include "Profiler.h"
+#include "Render.h"
+#include "Replay.h"
+#include "Frame.h"
+#include "Scene.h"
 
 // Initialize TFT object
-TFT_eSPI tft = TFT_eSPI();
-
-// Arrays to hold the top 5 scores for each game
-ScoreEntry snakeScores[5];
-ScoreEntry tetrisScores[5];
-
-// Function prototypes for score handling
-void insertNewScore(ScoreEntry scores[], int newScore);
-void writeScoresToSD(const char* filename, ScoreEntry scores[]);
-void readScoresFromSD(const char* filename, ScoreEntry scores[]);
+ArcadeDisplay tft = ArcadeDisplay();
 
 // Menu variables
 String games[] = {"Tetris", "Pong", "Snake", "Chess", "Scoreboard"};
@@ -31,6 +30,10 @@ int totalGames = sizeof(games) / sizeof(games[0]);
 extern int pauseButton;
 bool paused = false;
 
+// Attract mode: the autoplayer takes over after this long without input on the menu
+const unsigned long ATTRACT_DELAY = 60000;
+unsigned long menuIdleSince = 0;
+
 // =============================================================================================================
 
 void drawMenu() {
@@ -51,43 +54,115 @@ void drawMenu() {
 // =============================================================================================================
 
 void launchTetris() {
+  sceneBegin("Tetris");
+  profileStart("Tetris launch");
   tft.fillScreen(TFT_BLACK);
+  renderFinish();
+  profileMark("clear screen");
   tetrisSetup();
+  renderFinish();
+  profileMark("tetrisSetup");
+  profileReport();
   while (true) {
+    updateControllerInput();
     if (isPauseButtonPressed()) {
       esp_restart(); // Return to menu when pause button is pressed
     }
     tetrisLoop();
+    displayStatsFrame();
+  }
+}
+
+// Autoplayer demos for idle cabinets, alternating games at each game over.
+// Any real button press returns to the menu.
+void launchAttractMode() {
+  unsigned long demoStart = millis();
+  while (true) {
+    sceneBegin("Attract Tetris");
+    tft.fillScreen(TFT_BLACK);
+    tetrisSetup();
+    tetrisBotStart();
+    while (!gameover) {
+      if (lastInputMillis > demoStart) {
+        esp_restart(); // Return to menu on any controller input
+      }
+      tetrisBotUpdate();
+      tetrisLoop();
+      frameWait();
+      displayStatsFrame();
+    }
+    tetrisBotActive = false;
+
+    sceneBegin("Attract Snake");
+    tft.fillScreen(TFT_BLACK);
+    snakeSetup();
+    snakeBotStart();
+    while (!gameOver) {
+      if (lastInputMillis > demoStart) {
+        esp_restart(); // Return to menu on any controller input
+      }
+      snakeLoop();
+      frameWait();
+      displayStatsFrame();
+    }
+    snakeBotActive = false;
   }
 }
 
 void launchPong() {
+  sceneBegin("Pong");
+  profileStart("Pong launch");
   tft.fillScreen(TFT_BLACK);
+  renderFinish();
+  profileMark("clear screen");
   pongSetup();
+  renderFinish();
+  profileMark("pongSetup");
+  profileReport();
   while (true) {
+    updateControllerInput();
     pongLoop();
+    displayStatsFrame();
   }
 }
 
 void launchSnake() {
+  sceneBegin("Snake");
+  profileStart("Snake launch");
   tft.fillScreen(TFT_BLACK);
+  renderFinish();
+  profileMark("clear screen");
   snakeSetup();
+  renderFinish();
+  profileMark("snakeSetup");
+  profileReport();
   while (true) {
+    updateControllerInput();
     if (isPauseButtonPressed()) {
       esp_restart(); // Return to menu when pause button is pressed
     }
     snakeLoop();
+    displayStatsFrame();
   }
 }
 
 void launchChess() {
+  sceneBegin("Chess");
+  profileStart("Chess launch");
   tft.fillScreen(TFT_BLACK);
+  renderFinish();
+  profileMark("clear screen");
   chessSetup();
+  renderFinish();
+  profileMark("chessSetup");
+  profileReport();
   while (true) {
+    updateControllerInput();
     if (isPauseButtonPressed()) {
       esp_restart(); // Return to menu when pause button is pressed
     }
     chessLoop();
+    displayStatsFrame();
   }
   drawMenu();
 }
@@ -102,102 +177,51 @@ int isPauseButtonPressed() {
 // =============================================================================================================
 
 void setup() {
+  profileStart("Boot", 0); // From reset, to include the bootloader
+  profileMark("reset to setup()");
   pinMode(15, OUTPUT);
   digitalWrite(15, HIGH);
   Serial.begin(115200);
+  profileMark("Serial.begin");
   delay(1000);
+  profileMark("delay after Serial.begin");
+  renderBegin();
   tft.init();
+  renderFinish(); // Each drawing stage waits for the panel, so it times the drawing and not the list
+  profileMark("tft.init");
   tft.fillScreen(TFT_BLACK);
   tft.setRotation(4); // Adjust rotation as needed
   tft.setTextSize(2);
+  renderFinish();
+  profileMark("clear screen");
   initControllerInput();
+  profileMark("Wi-Fi + ESP-NOW");
 
-  // Random seed for food generation in snake
-  randomSeed(analogRead(0));
-
-  // Initialize SD card
-  if (!SD.begin(/* CS pin number */)) {
-    Serial.println("Card Mount Failed");
-    // Handle SD card initialization failure
-  } else {
-    Serial.println("SD Card initialized.");
-
-    // Read high scores from SD card
-    readScoresFromSD("/snake_scores.txt", snakeScores);
-    readScoresFromSD("/tetris_scores.txt", tetrisScores);
-  }
+  // Random seed for the games, recordings and replays set their own
+  replayRandomSeed(analogRead(0));
 
   drawMenu();
+  menuIdleSince = millis();
+  renderFinish();
+  profileMark("draw menu");
+
+  // The SD card is mounted and the high scores read in the background, the menu works meanwhile
+  storageBegin(loadLeaderboards);
+  profileMark("start storage task");
+  profileReport();
+  sceneBegin("Menu"); // Prints the scene before the restart, if there was one
 }
 
 // =============================================================================================================
 
-// Function to read scores from SD card
-void readScoresFromSD(const char* filename, ScoreEntry scores[]) {
-  File file = SD.open(filename, FILE_READ);
-  if (file) {
-    int index = 0;
-    while (file.available() && index < 5) {
-      String line = file.readStringUntil('\n');
-      line.trim();
-      int separatorIndex = line.indexOf(',');
-      if (separatorIndex != -1) {
-        scores[index].name = line.substring(0, separatorIndex);
-        scores[index].score = line.substring(separatorIndex + 1).toInt();
-        index++;
-      }
-    }
-    file.close();
-
-    // If fewer than 5 scores were read, initialize the rest
-    for (; index < 5; index++) {
-      scores[index].name = "---";
-      scores[index].score = 0;
-    }
-  } else {
-    // If file doesn't exist, initialize with default values
-    for (int i = 0; i < 5; i++) {
-      scores[i].name = "---";
-      scores[i].score = 0;
-    }
-  }
-}
-
-// Function to write scores to SD card
-void writeScoresToSD(const char* filename, ScoreEntry scores[]) {
-  SD.remove(filename); // Delete the file if it exists
-  File file = SD.open(filename, FILE_WRITE);
-  if (file) {
-    for (int i = 0; i < 5; i++) {
-      file.println(scores[i].name + "," + String(scores[i].score));
-    }
-    file.close();
-  } else {
-    Serial.println("Failed to open file for writing");
-  }
-}
-
-// Function to insert a new score into the top 5 scores list
-void insertNewScore(ScoreEntry scores[], int newScore) {
-  // Prompt for player name or initials (simplified here)
-  String playerName = getNameInput(); // Modify this to get input from the user if possible
-
-  // Create a new score entry
+// Function to insert a new score into a game's leaderboard
+void insertNewScore(LeaderboardId id, int32_t newScore) {
+  // Create a new score entry, prompting for the player's initials
   ScoreEntry newEntry;
-  newEntry.name = playerName;
+  getNameInput(newEntry.name);
   newEntry.score = newScore;
 
-  // Insert the new entry into the array
-  for (int i = 0; i < 5; i++) {
-    if (newScore > scores[i].score) {
-      // Shift lower scores down
-      for (int j = 4; j > i; j--) {
-        scores[j] = scores[j - 1];
-      }
-      scores[i] = newEntry;
-      break;
-    }
-  }
+  addScore(id, newEntry);
 }
 
 // =============================================================================================================
@@ -208,6 +232,7 @@ int preAState = 1;
 
 void loop() {
   updateControllerInput();
+  if (sceneRepaintRequested()) drawMenu();
   // Init bools to states of buttons
   int currUpState = upButton;
   int currDownState = downButton;
@@ -225,17 +250,25 @@ void loop() {
     drawMenu();
   }
 
-  // A button
+  // A button. Holding X records the game to the SD card, holding Y replays the last
+  // recording whichever game is selected.
   if (currAState == 0 && preAState == 1) {
-    if (currSelect == 0) {
+    int selection = currSelect;
+    if (yButton == 0) {
+      selection = replayStartPlayback();
+    } else if (xButton == 0 && currSelect != 4) {
+      replayStartRecording(currSelect);
+    }
+
+    if (selection == 0) {
       launchTetris();
-    } else if (currSelect == 1) {
+    } else if (selection == 1) {
       launchPong();
-    } else if (currSelect == 2) {
+    } else if (selection == 2) {
       launchSnake();
-    } else if (currSelect == 3) {
+    } else if (selection == 3) {
       launchChess();
-    } else if (currSelect == 4) {
+    } else if (selection == 4) {
       showScoreboard();
     }
   }
@@ -244,16 +277,25 @@ void loop() {
   preUpState = currUpState;
   preDownState = currDownState;
   preAState = currAState;
+
+  // Start the attract mode demo once nobody has touched a controller for a while
+  if (lastInputMillis > menuIdleSince) {
+    menuIdleSince = lastInputMillis;
+  }
+  if (millis() - menuIdleSince > ATTRACT_DELAY) {
+    launchAttractMode();
+  }
 }
 
 // =============================================================================================================
 
-String getNameInput() {
-  String playerName = "";
+// Fills name with up to 3 initials chosen on the controller
+void getNameInput(char name[SCORE_NAME_SIZE]) {
+  char playerName[SCORE_NAME_SIZE] = "";
   const char characters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
   int charIndex = 0;
   int nameLength = 0;
-  int maxNameLength = 3; // Maximum number of characters in the name
+  int maxNameLength = SCORE_NAME_SIZE - 1; // Maximum number of characters in the name
   bool selecting = true;
 
   tft.fillScreen(TFT_BLACK);
@@ -265,10 +307,13 @@ String getNameInput() {
     tft.drawString("Enter Your Name", 10, 10);
 
     // Display the current name
-    tft.drawString("Name: " + playerName, 10, 50);
+    char line[16];
+    snprintf(line, sizeof(line), "Name: %s", playerName);
+    tft.drawString(line, 10, 50);
 
     // Display the current character
-    tft.drawString(String(characters[charIndex]), 60, 100);
+    snprintf(line, sizeof(line), "%c", characters[charIndex]);
+    tft.drawString(line, 60, 100);
 
     tft.drawString("Use LEFT/RIGHT to change", 10, 150);
     tft.drawString("Press A to select", 10, 170);
@@ -278,6 +323,11 @@ String getNameInput() {
     while (true) {
       updateControllerInput();
 
+      if (sceneRepaintRequested()) {
+        // Draw the screen again
+        break;
+      }
+
       if (leftButton == 0) {
         // Move to previous character
         charIndex = (charIndex - 1 + sizeof(characters) - 1) % (sizeof(characters) - 1);
@@ -292,8 +342,8 @@ String getNameInput() {
 
       if (aButton == 0 && nameLength < maxNameLength) {
         // Add the selected character to the name
-        playerName += characters[charIndex];
-        nameLength++;
+        playerName[nameLength++] = characters[charIndex];
+        playerName[nameLength] = '\0';
         break;
       }
 
@@ -302,25 +352,23 @@ String getNameInput() {
         selecting = false;
         break;
       }
-
-      delay(100); // Small delay to debounce buttons
     }
 
-    delay(200); // Delay to prevent multiple inputs from a single press
+    framePause(200); // Pause to prevent multiple inputs from a single press
   }
 
   // If the player didn't enter any name, set a default
-  if (playerName.length() == 0) {
-    playerName = "AAA";
+  if (nameLength == 0) {
+    strcpy(playerName, "AAA");
   }
 
-  return playerName;
+  strcpy(name, playerName);
 }
 
 // ==================================================================
 
-// Function to display the scoreboard
-void showScoreboard() {
+// Draws the scoreboard, or a loading notice while the SD card is still being read
+void drawScoreboard() {
   tft.fillScreen(TFT_BLACK);
   tft.setTextColor(TFT_WHITE);
   tft.setTextSize(2);
@@ -330,35 +378,58 @@ void showScoreboard() {
 
   tft.setTextSize(1);
   int yPosition = 40;
+  char line[32];
 
-  // Display Snake Scores
-  tft.drawString("Snake:", 20, yPosition);
-  yPosition += 15;
-  for (int i = 0; i < 5; i++) {
-    tft.drawString(String(i + 1) + ". " + snakeScores[i].name + " - " + String(snakeScores[i].score), 20, yPosition);
-    yPosition += 15;
+  if (!leaderboardsReady()) {
+    tft.drawString(storageReady() ? "Loading scores..." : "Waiting for SD card...", 20, yPosition);
+    tft.drawString("Press B to return", 20, 305);
+    return;
   }
 
-  yPosition += 10;
+  // Display every registered leaderboard, empty places as "---"
+  for (int id = 0; id < LEADERBOARD_COUNT; id++) {
+    const LeaderboardInfo& info = leaderboardInfo((LeaderboardId)id);
+    const Leaderboard& board = getLeaderboard((LeaderboardId)id);
+
+    snprintf(line, sizeof(line), "%s (%s):", info.title, info.unit);
+    tft.drawString(line, 20, yPosition);
+    yPosition += 12;
+    for (int i = 0; i < info.size; i++) {
+      if (i < board.count) {
+        snprintf(line, sizeof(line), "%d. %s - %ld", i + 1, board.entries[i].name, (long)board.entries[i].score);
+      } else {
+        snprintf(line, sizeof(line), "%d. ---", i + 1);
+      }
+      tft.drawString(line, 20, yPosition);
+      yPosition += 12;
+    }
 
-  // Display Tetris Scores
-  tft.drawString("Tetris:", 20, yPosition);
-  yPosition += 15;
-  for (int i = 0; i < 5; i++) {
-    tft.drawString(String(i + 1) + ". " + tetrisScores[i].name + " - " + String(tetrisScores[i].score), 20, yPosition);
-    yPosition += 15;
+    yPosition += 6;
   }
 
-  tft.drawString("Press B to return", 20, 240);
+  tft.drawString("Press B to return", 20, 305);
+}
 
-  // Wait for user to press 'B' to return to the menu
+// Function to display the scoreboard
+void showScoreboard() {
+  sceneBegin("Scoreboard");
+  bool ready = leaderboardsReady();
+  drawScoreboard();
+
+  // Wait for user to press 'B' to return to the menu, filling the tables in once they are read
   while (true) {
+    if (!ready && leaderboardsReady()) {
+      ready = true;
+      drawScoreboard();
+    } else if (sceneRepaintRequested()) {
+      drawScoreboard();
+    }
     updateControllerInput();
     if (bButton == 0) {
+      sceneBegin("Menu");
       drawMenu();
       break;
     }
-    delay(100);
   }
 }
 
@@ -1,7 +1,9 @@
 #include "Chess.h"
+#include "Scores.h"
+#include "Frame.h"
 
 // Definition of global variables
-Piece board[8][8];
+ChessState* chess = NULL;
 PlayerColor currentPlayer = WHITE;
 int cursorX = 0;
 int cursorY = 0;
@@ -14,6 +16,8 @@ int prevDownState = 1;
 int prevAState = 1;
 int prevBState = 1;
 int swapInt = 0;
+int chessPlies = 0; // Moves made by both players this game
+bool chessDemo = false;
 int currLeftState = leftButton;
 int currRightState = rightButton;
 int currUpState = upButton;
@@ -26,23 +30,26 @@ int enPassantX = -1;
 int enPassantY = -1;
 
 void chessSetup() {
+  sceneState(chess);
   // Initialize the board with starting positions
   // Set up pieces for both players
+  chessPlies = 0;
+  frameSetPeriod(FRAME_PERIOD_DEFAULT);
 
   // Initialize all squares to empty
   for (int y = 0; y < 8; y++) {
     for (int x = 0; x < 8; x++) {
-      board[y][x].type = EMPTY;
-      board[y][x].color = NONE;
+      chess->board[y][x].type = EMPTY;
+      chess->board[y][x].color = NONE;
     }
   }
 
   // Place pawns
   for (int x = 0; x < 8; x++) {
-    board[1][x].type = PAWN;
-    board[1][x].color = BLACK;
-    board[6][x].type = PAWN;
-    board[6][x].color = WHITE;
+    chess->board[1][x].type = PAWN;
+    chess->board[1][x].color = BLACK;
+    chess->board[6][x].type = PAWN;
+    chess->board[6][x].color = WHITE;
   }
 
   // Place other pieces
@@ -50,12 +57,12 @@ void chessSetup() {
 
   for (int x = 0; x < 8; x++) {
     // Black back rank
-    board[0][x].type = backRank[x];
-    board[0][x].color = BLACK;
+    chess->board[0][x].type = backRank[x];
+    chess->board[0][x].color = BLACK;
 
     // White back rank
-    board[7][x].type = backRank[x];
-    board[7][x].color = WHITE;
+    chess->board[7][x].type = backRank[x];
+    chess->board[7][x].color = WHITE;
   }
 
   // Draw the initial board
@@ -102,12 +109,12 @@ void drawBoard() {
       tft.fillRect(posX, posY, squareSize, squareSize, squareColor);
 
       // Draw piece if present
-      if (board[y][x].type != EMPTY) {
+      if (chess->board[y][x].type != EMPTY) {
         // Set piece color
-        uint16_t pieceColor = (board[y][x].color == WHITE) ? TFT_WHITE : TFT_BLACK;
+        uint16_t pieceColor = (chess->board[y][x].color == WHITE) ? TFT_WHITE : TFT_BLACK;
 
         // Draw the piece
-        drawPiece(board[y][x], posX, posY, squareSize, pieceColor, squareColor);
+        drawPiece(chess->board[y][x], posX, posY, squareSize, pieceColor, squareColor);
       }
 
       // Highlight available moves if a piece is selected
@@ -254,7 +261,7 @@ void handleInput() {
   if (currAState == 0 && prevAState == 1) {
     if (selectedX == -1 && selectedY == -1) {
       // No piece selected, try to select a piece
-      if (board[cursorY][cursorX].type != EMPTY && board[cursorY][cursorX].color == currentPlayer) {
+      if (chess->board[cursorY][cursorX].type != EMPTY && chess->board[cursorY][cursorX].color == currentPlayer) {
         selectedX = cursorX;
         selectedY = cursorY;
         drawBoard();
@@ -294,6 +301,7 @@ void resetSelection() {
 
 void switchPlayer() {
   currentPlayer = (currentPlayer == WHITE) ? BLACK : WHITE;
+  chessPlies++;
   swapInt = ((swapInt + 1) % 2);
 }
 
@@ -308,8 +316,8 @@ bool isLegalMove(int fromX, int fromY, int toX, int toY) {
     return false;
   }
 
-  Piece piece = board[fromY][fromX];
-  Piece target = board[toY][toX];
+  Piece piece = chess->board[fromY][fromX];
+  Piece target = chess->board[toY][toX];
 
   // Cannot capture own piece
   if (target.color == piece.color) {
@@ -337,7 +345,7 @@ bool isLegalMove(int fromX, int fromY, int toX, int toY) {
       }
 
       // Double move from starting position
-      if (!piece.hasMoved && dx == 0 && dy == 2 * direction && target.type == EMPTY && board[fromY + direction][fromX].type == EMPTY) {
+      if (!piece.hasMoved && dx == 0 && dy == 2 * direction && target.type == EMPTY && chess->board[fromY + direction][fromX].type == EMPTY) {
         validMove = true;
       }
 
@@ -382,7 +390,7 @@ bool isLegalMove(int fromX, int fromY, int toX, int toY) {
       // Castling
       if (!piece.hasMoved && dy == 0 && (dx == 2 || dx == -2)) {
         int rookX = (dx == 2) ? 7 : 0;
-        Piece rook = board[fromY][rookX];
+        Piece rook = chess->board[fromY][rookX];
         if (rook.type == ROOK && rook.color == piece.color && !rook.hasMoved) {
           if (isPathClear(fromX, fromY, rookX, fromY)) {
             // Ensure squares king passes through are not under attack
@@ -390,18 +398,18 @@ bool isLegalMove(int fromX, int fromY, int toX, int toY) {
             for (int i = 1; i <= abs(dx); i++) {
               int x = fromX + i * step;
               // Temporarily move the king to each square to check for attacks
-              Piece originalFrom = board[fromY][fromX];
-              Piece originalTo = board[fromY][x];
-              board[fromY][x] = piece;
-              board[fromY][fromX].type = EMPTY;
-              board[fromY][fromX].color = NONE;
-              board[fromY][fromX].hasMoved = false;
+              Piece originalFrom = chess->board[fromY][fromX];
+              Piece originalTo = chess->board[fromY][x];
+              chess->board[fromY][x] = piece;
+              chess->board[fromY][fromX].type = EMPTY;
+              chess->board[fromY][fromX].color = NONE;
+              chess->board[fromY][fromX].hasMoved = false;
 
               bool inCheck = isInCheck(currentPlayer);
 
               // Undo the move
-              board[fromY][fromX] = originalFrom;
-              board[fromY][x] = originalTo;
+              chess->board[fromY][fromX] = originalFrom;
+              chess->board[fromY][x] = originalTo;
 
               if (inCheck) {
                 return false;
@@ -421,19 +429,19 @@ bool isLegalMove(int fromX, int fromY, int toX, int toY) {
   }
 
   // Simulate the move to check if it puts own king in check
-  Piece originalFrom = board[fromY][fromX];
-  Piece originalTo = board[toY][toX];
+  Piece originalFrom = chess->board[fromY][fromX];
+  Piece originalTo = chess->board[toY][toX];
 
-  board[toY][toX] = board[fromY][fromX];
-  board[fromY][fromX].type = EMPTY;
-  board[fromY][fromX].color = NONE;
-  board[fromY][fromX].hasMoved = false;
+  chess->board[toY][toX] = chess->board[fromY][fromX];
+  chess->board[fromY][fromX].type = EMPTY;
+  chess->board[fromY][fromX].color = NONE;
+  chess->board[fromY][fromX].hasMoved = false;
 
   bool inCheck = isInCheck(currentPlayer);
 
   // Undo the move
-  board[fromY][fromX] = originalFrom;
-  board[toY][toX] = originalTo;
+  chess->board[fromY][fromX] = originalFrom;
+  chess->board[toY][toX] = originalTo;
 
   if (inCheck) {
     return false;
@@ -447,7 +455,7 @@ bool isInCheck(PlayerColor color) {
   int kingX = -1, kingY = -1;
   for (int y = 0; y < 8; y++) {
     for (int x = 0; x < 8; x++) {
-      if (board[y][x].type == KING && board[y][x].color == color) {
+      if (chess->board[y][x].type == KING && chess->board[y][x].color == color) {
         kingX = x;
         kingY = y;
         break;
@@ -463,7 +471,7 @@ bool isInCheck(PlayerColor color) {
   // Check if any enemy piece can attack the king
   for (int y = 0; y < 8; y++) {
     for (int x = 0; x < 8; x++) {
-      if (board[y][x].color != color && board[y][x].color != NONE) {
+      if (chess->board[y][x].color != color && chess->board[y][x].color != NONE) {
         if (isAttacking(x, y, kingX, kingY)) {
           return true;
         }
@@ -474,7 +482,7 @@ bool isInCheck(PlayerColor color) {
 }
 
 bool isAttacking(int fromX, int fromY, int toX, int toY) {
-  Piece piece = board[fromY][fromX];
+  Piece piece = chess->board[fromY][fromX];
   int dx = toX - fromX;
   int dy = toY - fromY;
 
@@ -528,7 +536,7 @@ bool isPathClear(int fromX, int fromY, int toX, int toY) {
   int y = fromY + stepY;
 
   while (x != toX || y != toY) {
-    if (board[y][x].type != EMPTY) {
+    if (chess->board[y][x].type != EMPTY) {
       return false;
     }
     x += stepX;
@@ -543,19 +551,19 @@ bool isWithinBoard(int x, int y) {
 
 void movePiece(int fromX, int fromY, int toX, int toY) {
   // Move the piece
-  board[toY][toX] = board[fromY][fromX];
-  board[toY][toX].hasMoved = true;
-  board[fromY][fromX].type = EMPTY;
-  board[fromY][fromX].color = NONE;
-  board[fromY][fromX].hasMoved = false;
+  chess->board[toY][toX] = chess->board[fromY][fromX];
+  chess->board[toY][toX].hasMoved = true;
+  chess->board[fromY][fromX].type = EMPTY;
+  chess->board[fromY][fromX].color = NONE;
+  chess->board[fromY][fromX].hasMoved = false;
 
   // Check for en passant capture
-  if (board[toY][toX].type == PAWN) {
+  if (chess->board[toY][toX].type == PAWN) {
     if (toX == enPassantX && toY == enPassantY) {
       int capturedPawnY = (currentPlayer == WHITE) ? toY + 1 : toY - 1;
-      board[capturedPawnY][toX].type = EMPTY;
-      board[capturedPawnY][toX].color = NONE;
-      board[capturedPawnY][toX].hasMoved = false;
+      chess->board[capturedPawnY][toX].type = EMPTY;
+      chess->board[capturedPawnY][toX].color = NONE;
+      chess->board[capturedPawnY][toX].hasMoved = false;
     }
   }
 
@@ -564,34 +572,34 @@ void movePiece(int fromX, int fromY, int toX, int toY) {
   enPassantY = -1;
 
   // Check if pawn moved two squares forward (for en passant)
-  if (board[toY][toX].type == PAWN && abs(toY - fromY) == 2) {
+  if (chess->board[toY][toX].type == PAWN && abs(toY - fromY) == 2) {
     enPassantX = toX;
     enPassantY = (fromY + toY) / 2;
   }
 
   // Handle castling
-  if (board[toY][toX].type == KING && abs(toX - fromX) == 2) {
+  if (chess->board[toY][toX].type == KING && abs(toX - fromX) == 2) {
     if (toX == 6) {
       // Kingside castling
-      board[toY][5] = board[toY][7];
-      board[toY][5].hasMoved = true;
-      board[toY][7].type = EMPTY;
-      board[toY][7].color = NONE;
-      board[toY][7].hasMoved = false;
+      chess->board[toY][5] = chess->board[toY][7];
+      chess->board[toY][5].hasMoved = true;
+      chess->board[toY][7].type = EMPTY;
+      chess->board[toY][7].color = NONE;
+      chess->board[toY][7].hasMoved = false;
     } else if (toX == 2) {
       // Queenside castling
-      board[toY][3] = board[toY][0];
-      board[toY][3].hasMoved = true;
-      board[toY][0].type = EMPTY;
-      board[toY][0].color = NONE;
-      board[toY][0].hasMoved = false;
+      chess->board[toY][3] = chess->board[toY][0];
+      chess->board[toY][3].hasMoved = true;
+      chess->board[toY][0].type = EMPTY;
+      chess->board[toY][0].color = NONE;
+      chess->board[toY][0].hasMoved = false;
     }
   }
 
   // Handle pawn promotion
-  if (board[toY][toX].type == PAWN && (toY == 0 || toY == 7)) {
+  if (chess->board[toY][toX].type == PAWN && (toY == 0 || toY == 7)) {
     // Promote pawn to queen
-    board[toY][toX].type = QUEEN;
+    chess->board[toY][toX].type = QUEEN;
   }
 }
 
@@ -607,7 +615,16 @@ void checkGameOver() {
     } else {
       tft.drawString("White Wins!", tft.width() / 2, tft.height() / 2);
     }
-    delay(5000);
+    framePause(5000);
+
+    // Quickest wins go on the leaderboard, counting the winner's moves (demo games don't count)
+    int winnerMoves = (chessPlies + 1) / 2;
+    if (!chessDemo) {
+      recordGamePlayed(LEADERBOARD_CHESS, winnerMoves);
+      if (scoreQualifies(LEADERBOARD_CHESS, winnerMoves)) {
+        insertNewScore(LEADERBOARD_CHESS, winnerMoves);
+      }
+    }
     chessSetup();
   } else if (isInStalemate(currentPlayer)) {
     // Stalemate
@@ -616,7 +633,7 @@ void checkGameOver() {
     tft.setTextSize(3);
     tft.setTextDatum(MC_DATUM);
     tft.drawString("Stalemate!", tft.width() / 2, tft.height() / 2);
-    delay(5000);
+    framePause(5000);
     chessSetup();
   }
 }
@@ -628,7 +645,7 @@ bool isInCheckmate(PlayerColor color) {
   // Check if the player has any legal moves
   for (int fromY = 0; fromY < 8; fromY++) {
     for (int fromX = 0; fromX < 8; fromX++) {
-      if (board[fromY][fromX].color == color) {
+      if (chess->board[fromY][fromX].color == color) {
         for (int toY = 0; toY < 8; toY++) {
           for (int toX = 0; toX < 8; toX++) {
             if (isLegalMove(fromX, fromY, toX, toY)) {
@@ -649,7 +666,7 @@ bool isInStalemate(PlayerColor color) {
   // Check if the player has any legal moves
   for (int fromY = 0; fromY < 8; fromY++) {
     for (int fromX = 0; fromX < 8; fromX++) {
-      if (board[fromY][fromX].color == color) {
+      if (chess->board[fromY][fromX].color == color) {
         for (int toY = 0; toY < 8; toY++) {
           for (int toX = 0; toX < 8; toX++) {
             if (isLegalMove(fromX, fromY, toX, toY)) {
@@ -664,6 +681,7 @@ bool isInStalemate(PlayerColor color) {
 }
 
 void chessLoop() {
+  if (sceneRepaintRequested()) drawBoard();
   handleInput();
   // No need to delay here; handleInput should handle button debouncing
 }
@@ -1,10 +1,11 @@
 #ifndef CHESS_H
 #define CHESS_H
 
-#include <TFT_eSPI.h> // Assumes tft object is globally accessible
+#include "Render.h" // Assumes tft object is globally accessible
+#include "Scene.h"
 
 // External declarations for global variables
-extern TFT_eSPI tft; // Declare TFT object
+extern ArcadeDisplay tft; // Declare TFT object
 extern int leftButton; // Declare button variables
 extern int rightButton;
 extern int upButton;
@@ -44,13 +45,19 @@ typedef struct {
   bool hasMoved;
 } Piece;
 
+// Board, in the scene arena (Scene.h) while Chess runs
+struct ChessState {
+  Piece board[8][8];
+};
+
 // External declarations of variables
-extern Piece board[8][8];
+extern ChessState* chess;
 extern PlayerColor currentPlayer;
 extern int cursorX;
 extern int cursorY;
 extern int selectedX;
 extern int selectedY;
+extern bool chessDemo; // Scripted games (the benchmark), kept off the scoreboard and the stats
 
 extern int prevLeftState;
 extern int prevRightState;
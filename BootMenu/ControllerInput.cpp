@@ -1,6 +1,8 @@
 // ControllerInput.cpp
 
 #include "ControllerInput.h"
+#include "Replay.h"
+#include "Frame.h"
 
 // Controller 1 button states
 int leftButton = 1;
@@ -32,11 +34,19 @@ int pauseButton2 = 1;
 uint8_t controller1MAC[6] = {0};
 uint8_t controller2MAC[6] = {0};
 
+// Called at every frame boundary when set, see setFrameHook()
+void (*frameHook)() = NULL;
+
+// millis() and micros() of the last real button press
+volatile unsigned long lastInputMillis = 0;
+volatile unsigned long lastInputMicros = 0;
+
 // Button names and their indices
 const char* buttonNames[11] = {"LEFT", "RIGHT", "UP", "DOWN", "X", "Y", "A", "B", "M", "P", "PAUSE"};
 
 // Receive callback function
 void onDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len) {
+  if (len < (int)sizeof(uint16_t)) return; // Too short for the button states
   uint16_t receivedData;
   memcpy(&receivedData, incomingData, sizeof(receivedData));
 
@@ -64,9 +74,34 @@ void onDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len) {
     }
   }
 
-  // Update button states for the identified controller
+  // Update button states for the identified controller. While recording, packets wait for
+  // the next frame so a replay can apply them at the same point.
+  if (!replayTakePacket(controllerNumber, receivedData)) {
+    applyButtonMask(controllerNumber, receivedData);
+  }
+  if ((receivedData & BUTTONS_RELEASED) != BUTTONS_RELEASED) {
+    lastInputMillis = millis();
+    lastInputMicros = micros();
+  }
+
+  // For debugging: Print button states
+  Serial.print("Controller ");
+  Serial.print(controllerNumber);
+  Serial.print(" button states updated: ");
   for (int i = 0; i < 11; i++) {
-    int buttonState = (receivedData & (1 << i)) ? 1 : 0; // 0 for pressed, 1 for not pressed
+    int buttonState = (receivedData & (1 << i)) ? 1 : 0;
+    if (buttonState == 0) { // Button is pressed
+      Serial.print(buttonNames[i]);
+      Serial.print(" ");
+    }
+  }
+  Serial.println();
+}
+
+// Set the button states of a controller from a packet value
+void applyButtonMask(int controllerNumber, uint16_t mask) {
+  for (int i = 0; i < 11; i++) {
+    int buttonState = (mask & (1 << i)) ? 1 : 0; // 0 for pressed, 1 for not pressed
     if (controllerNumber == 1) {
       switch (i) {
         case 0: leftButton = buttonState; break;
@@ -97,19 +132,18 @@ void onDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len) {
       }
     }
   }
+}
 
-  // For debugging: Print button states
-  Serial.print("Controller ");
-  Serial.print(controllerNumber);
-  Serial.print(" button states updated: ");
+// Get the packet value matching the button states of a controller
+uint16_t buttonMask(int controllerNumber) {
+  int states1[11] = {leftButton, rightButton, upButton, downButton, xButton, yButton, aButton, bButton, mButton, pButton, pauseButton};
+  int states2[11] = {leftButton2, rightButton2, upButton2, downButton2, xButton2, yButton2, aButton2, bButton2, mButton2, pButton2, pauseButton2};
+  const int* states = (controllerNumber == 1) ? states1 : states2;
+  uint16_t mask = 0;
   for (int i = 0; i < 11; i++) {
-    int buttonState = (receivedData & (1 << i)) ? 1 : 0;
-    if (buttonState == 0) { // Button is pressed
-      Serial.print(buttonNames[i]);
-      Serial.print(" ");
-    }
+    if (states[i] != 0) mask |= 1 << i;
   }
-  Serial.println();
+  return mask;
 }
 
 // Utility function to convert MAC address to string
@@ -142,7 +176,16 @@ void initControllerInput() {
   Serial.println("ESP-NOW initialized and receive callback registered.");
 }
 
-// Update controller input (if needed in loop)
+// Update controller input, the frame boundary: what was drawn goes to the panel, the frame
+// waits out its period, and recordings and replays move on a frame
 void updateControllerInput() {
-  // Currently, no periodic tasks are required
+  frameWait();
+  if (frameHook != NULL) {
+    frameHook();
+  }
+  replayFrame();
+}
+
+void setFrameHook(void (*hook)()) {
+  frameHook = hook;
 }
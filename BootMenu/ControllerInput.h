@@ -10,6 +10,28 @@
 // Maximum number of controllers
 #define MAX_CONTROLLERS 2
 
+// Bit positions of the buttons in a controller packet (a cleared bit means pressed)
+enum ControllerButton {
+  BUTTON_LEFT = 0,
+  BUTTON_RIGHT,
+  BUTTON_UP,
+  BUTTON_DOWN,
+  BUTTON_X,
+  BUTTON_Y,
+  BUTTON_A,
+  BUTTON_B,
+  BUTTON_M,
+  BUTTON_P,
+  BUTTON_PAUSE,
+  BUTTON_COUNT
+};
+
+// Packet value with every button released
+#define BUTTONS_RELEASED ((1 << BUTTON_COUNT) - 1)
+
+// Packet value with only the given button pressed
+#define BUTTON_PRESSED(button) (BUTTONS_RELEASED & ~(1 << (button)))
+
 // Controller 1 button states
 extern int leftButton;
 extern int rightButton;
@@ -46,10 +68,25 @@ typedef struct {
 // Extern declarations
 //extern Controller controllers[MAX_CONTROLLERS];
 
+// millis() of the last packet from a real controller with any button pressed
+extern volatile unsigned long lastInputMillis;
+
+// The same packet's micros(), for measuring input latency
+extern volatile unsigned long lastInputMicros;
+
 // Function to initialize controller input
 void initControllerInput();
 
-// Function to process controller input (call in loop if needed)
+// Function to set the button states of controller 1 or 2 from a packet value
+void applyButtonMask(int controllerNumber, uint16_t mask);
+
+// Function to get the packet value matching the current button states of controller 1 or 2
+uint16_t buttonMask(int controllerNumber);
+
+// Function to process controller input, called once per pass of every game loop (a frame)
 void updateControllerInput();
 
+// Function to have a tool (the host's golden-frame check) called at every frame boundary
+void setFrameHook(void (*hook)());
+
 #endif // CONTROLLER_INPUT_H
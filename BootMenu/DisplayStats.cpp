@@ -0,0 +1,122 @@
+// DisplayStats.cpp
+
+#include "DisplayStats.h"
+
+#if defined(DISPLAY_STATS) || defined(PERF_HUD)
+
+uint32_t displayTotalBytes = 0;   // Never reset, unlike the per-second counts
+
+void displayStatsCountTotal(uint32_t pixels) {
+  displayTotalBytes += displayStatsBytes(1, pixels);
+}
+
+uint32_t displayStatsTotalBytes() {
+  return displayTotalBytes;
+}
+
+#endif
+
+#ifdef DISPLAY_STATS
+
+// Function prototypes (private to this file)
+void displayStatsPrint(unsigned long elapsedMillis);
+
+DisplayCallSite displaySites[DISPLAY_STATS_MAX_SITES];
+int displaySiteCount = 0;
+int displayLastSite = 0;   // Loops tend to repeat the same call, so try it first
+uint32_t displayCalls = 0;
+uint32_t displayPixels = 0;
+uint32_t displayFrames = 0;
+uint32_t displayCallsAtFrame = 0; // Loop passes that drew nothing aren't frames
+unsigned long displayWindowStart = 0;
+
+// =============================================================================================================
+
+// __builtin_FILE() gives the same pointer for every call in a file, so pointers are compared
+void displayStatsCount(const char* file, int line, uint32_t pixels) {
+  displayStatsCountTotal(pixels);
+  displayCalls++;
+  displayPixels += pixels;
+
+  int site = displayLastSite;
+  if (site >= displaySiteCount || displaySites[site].line != line || displaySites[site].file != file) {
+    for (site = 0; site < displaySiteCount; site++) {
+      if (displaySites[site].line == line && displaySites[site].file == file) break;
+    }
+    if (site == displaySiteCount) {
+      if (displaySiteCount == DISPLAY_STATS_MAX_SITES) return;
+      displaySites[site].file = file;
+      displaySites[site].line = line;
+      displaySites[site].calls = 0;
+      displaySites[site].pixels = 0;
+      displaySiteCount++;
+    }
+    displayLastSite = site;
+  }
+  displaySites[site].calls++;
+  displaySites[site].pixels += pixels;
+}
+
+// The host benchmark reads the counts itself, so the host build never prints or resets
+void displayStatsFrame() {
+  if (displayCalls == displayCallsAtFrame) return;
+  displayCallsAtFrame = displayCalls;
+  displayFrames++;
+#ifndef ARCADE_HOST
+  unsigned long now = millis();
+  if (now - displayWindowStart >= 1000) {
+    displayStatsPrint(now - displayWindowStart);
+    displayStatsReset();
+    displayWindowStart = now;
+  }
+#endif
+}
+
+void displayStatsReset() {
+  displaySiteCount = 0;
+  displayLastSite = 0;
+  displayCalls = 0;
+  displayPixels = 0;
+  displayFrames = 0;
+  displayCallsAtFrame = 0;
+}
+
+const DisplayCallSite* displayStatsSites(int* count) {
+  *count = displaySiteCount;
+  return displaySites;
+}
+
+uint32_t displayStatsFrames() {
+  return displayFrames;
+}
+
+// =============================================================================================================
+
+void displayStatsPrint(unsigned long elapsedMillis) {
+  uint32_t frames = displayFrames > 0 ? displayFrames : 1;
+  Serial.printf("Display: %lu fps, %lu calls/frame, %lu px/frame, %lu bytes/s\n",
+                (unsigned long)displayFrames * 1000 / elapsedMillis, (unsigned long)(displayCalls / frames),
+                (unsigned long)(displayPixels / frames),
+                (unsigned long)((uint64_t)displayStatsBytes(displayCalls, displayPixels) * 1000 / elapsedMillis));
+
+  // Busiest sites first, picked one at a time so the table stays in place
+  bool listed[DISPLAY_STATS_MAX_SITES] = {};
+  for (int n = 0; n < DISPLAY_STATS_REPORT_SITES && n < displaySiteCount; n++) {
+    int best = -1;
+    for (int i = 0; i < displaySiteCount; i++) {
+      if (listed[i]) continue;
+      if (best < 0 || displayStatsBytes(displaySites[i].calls, displaySites[i].pixels) >
+                          displayStatsBytes(displaySites[best].calls, displaySites[best].pixels)) {
+        best = i;
+      }
+    }
+    listed[best] = true;
+
+    const char* name = strrchr(displaySites[best].file, '/');
+    name = name != NULL ? name + 1 : displaySites[best].file;
+    Serial.printf("  %s:%d  %lu calls, %lu px\n", name, displaySites[best].line,
+                  (unsigned long)displaySites[best].calls, (unsigned long)displaySites[best].pixels);
+  }
+}
+
+#endif // DISPLAY_STATS
@@ -0,0 +1,106 @@
+// DisplayStats.h
+//
+// Optional accounting of the display bus: every drawing call on tft is counted with the
+// pixels it writes, per call site (file and line). Define DISPLAY_STATS to turn it on, here or
+// with -DDISPLAY_STATS; without it the drawing calls take no extra arguments and release
+// builds pay nothing. Pixels for text and shapes are estimates from their size, the library
+// doesn't report what it wrote.
+
+#ifndef DISPLAY_STATS_H
+#define DISPLAY_STATS_H
+
+#include <Arduino.h>
+#include "PerfHud.h" // The HUD shows the bus bytes, so PERF_HUD keeps the totals as well
+
+// #define DISPLAY_STATS
+
+#if defined(DISPLAY_STATS) || defined(PERF_HUD)
+
+// Bus bytes for each call before its pixels: column, row and memory write commands
+const uint32_t DISPLAY_STATS_CALL_BYTES = 11;
+
+/**
+ * @brief Bus bytes for a number of calls and pixels.
+ */
+inline uint32_t displayStatsBytes(uint32_t calls, uint32_t pixels) {
+  return calls * DISPLAY_STATS_CALL_BYTES + pixels * 2;
+}
+
+/**
+ * @brief Adds one drawing call to the totals only. Called by ArcadeDisplay, not by games.
+ */
+void displayStatsCountTotal(uint32_t pixels);
+
+/**
+ * @brief Returns the bus bytes of all drawing calls since boot. Wraps around, use differences.
+ */
+uint32_t displayStatsTotalBytes();
+
+#endif
+
+#ifdef DISPLAY_STATS
+
+// Call sites tracked, calls from further sites are only in the totals
+const int DISPLAY_STATS_MAX_SITES = 48;
+
+// Sites listed in the serial summary, busiest first
+const int DISPLAY_STATS_REPORT_SITES = 5;
+
+struct DisplayCallSite {
+  const char* file;
+  int line;
+  uint32_t calls;
+  uint32_t pixels;
+};
+
+/**
+ * @brief Counts one drawing call. Called by ArcadeDisplay, not by games.
+ */
+void displayStatsCount(const char* file, int line, uint32_t pixels);
+
+/**
+ * @brief Marks the end of a pass of a game loop, which is a frame if it drew anything.
+ *
+ * On the device this prints a summary over serial once a second (frames, calls, pixels and
+ * bus bytes per frame, then the busiest call sites) and starts counting again.
+ */
+void displayStatsFrame();
+
+/**
+ * @brief Forgets all counts.
+ */
+void displayStatsReset();
+
+/**
+ * @brief Returns the call sites counted since the last reset, in order of first use.
+ * @param count Set to the number of entries.
+ */
+const DisplayCallSite* displayStatsSites(int* count);
+
+/**
+ * @brief Returns the frames marked since the last reset.
+ */
+uint32_t displayStatsFrames();
+
+// Extra parameters of the ArcadeDisplay drawing calls (Render.h): the caller's file and
+// line come in through default arguments
+#define DISPLAY_STATS_SITE , const char* file = __builtin_FILE(), int line = __builtin_LINE()
+#define DISPLAY_STATS_COUNT(pixels) displayStatsCount(file, line, pixels)
+
+#elif defined(PERF_HUD)
+
+#define DISPLAY_STATS_SITE
+#define DISPLAY_STATS_COUNT(pixels) displayStatsCountTotal(pixels)
+
+inline void displayStatsFrame() {}
+
+#else
+
+#define DISPLAY_STATS_SITE
+#define DISPLAY_STATS_COUNT(pixels)
+
+inline void displayStatsFrame() {}
+
+#endif // DISPLAY_STATS
+
+#endif // DISPLAY_STATS_H
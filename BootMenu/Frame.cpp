@@ -0,0 +1,101 @@
+// Frame.cpp
+
+#include "Frame.h"
+#include "Render.h"
+#include "PerfHud.h"
+#include "MemoryStats.h"
+#ifndef ARCADE_HOST
+#include <esp_timer.h>
+#endif
+
+FrameStats frameCounters = {0, 0, FRAME_PERIOD_DEFAULT, 0, 0};
+unsigned long frameStart = 0;      // micros() the current frame started at
+unsigned long frameDeadline = 0;   // micros() the current frame is due to end at
+bool frameRunning = false;         // False until the first frame ends, and after a pause
+
+#ifndef ARCADE_HOST
+esp_timer_handle_t frameTimer = NULL;
+TaskHandle_t frameTask = NULL;     // Task that sleeps in frameWait(), woken by the timer
+#endif
+
+// Function prototypes (private to this file)
+void frameSleep(unsigned long duration);
+void frameTimerFired(void* parameter);
+
+// =============================================================================================================
+
+void frameSetPeriod(unsigned long periodMicros) {
+  frameCounters.periodMicros = periodMicros;
+}
+
+unsigned long framePeriod() {
+  return frameCounters.periodMicros;
+}
+
+void frameWait() {
+  perfHudFrame();
+  memoryStatsFrame();
+  renderSubmit();
+  unsigned long now = micros();
+  if (!frameRunning) {
+    // First frame, or the first after a pause: nothing to measure, the next is a period away
+    frameRunning = true;
+    frameDeadline = now;
+  } else {
+    frameCounters.frames++;
+    frameCounters.frameMicros = now - frameStart;
+  }
+
+  frameDeadline += frameCounters.periodMicros;
+  long slack = (long)(frameDeadline - now);
+  if (slack > 0) {
+    frameCounters.slackMicros = slack;
+    frameSleep(slack);
+  } else {
+    // Late: start the next frame now, without shortening later ones to make up
+    frameCounters.slackMicros = 0;
+    frameCounters.lateFrames++;
+    frameDeadline = now;
+  }
+  frameStart = micros();
+}
+
+void framePause(unsigned long ms) {
+  renderSubmit();
+  frameSleep(ms * 1000);
+  frameRunning = false;
+}
+
+const FrameStats& frameStats() {
+  return frameCounters;
+}
+
+// =============================================================================================================
+
+#ifdef ARCADE_HOST
+void frameSleep(unsigned long duration) {
+  delayMicroseconds(duration);
+}
+#else
+// Blocks on a one-shot esp_timer, which keeps microseconds where vTaskDelay() has 1 ms ticks.
+// The render task notifies this task too, so wake-ups before the deadline go back to sleep.
+void frameSleep(unsigned long duration) {
+  if (frameTimer == NULL) {
+    frameTask = xTaskGetCurrentTaskHandle();
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = frameTimerFired;
+    timerArgs.name = "frame";
+    esp_timer_create(&timerArgs, &frameTimer);
+  }
+  unsigned long wakeAt = micros() + duration;
+  esp_timer_stop(frameTimer); // In case an early wake-up left it running
+  esp_timer_start_once(frameTimer, duration);
+  while ((long)(wakeAt - micros()) > 0) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+void frameTimerFired(void* parameter) {
+  xTaskNotifyGive(frameTask);
+}
+#endif
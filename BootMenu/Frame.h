@@ -0,0 +1,56 @@
+// Frame.h
+//
+// Frame pacing for every scene. Each scene sets its frame period; updateControllerInput()
+// ends a frame by handing the drawing to the panel and sleeping until the next frame is due.
+// Deadlines follow each other at exactly the period, like a vsync, and a frame that runs late
+// starts the next one at once rather than trying to catch up. The time left over is spent
+// blocked on an esp_timer wake-up, so FreeRTOS runs the other tasks or idles meanwhile.
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <Arduino.h>
+
+// Menus, the scoreboard and Chess: 50 frames a second
+const unsigned long FRAME_PERIOD_DEFAULT = 20000;
+
+struct FrameStats {
+  uint32_t frames;            // Frames ended since boot
+  uint32_t lateFrames;        // Frames that ended after their deadline
+  unsigned long periodMicros; // Current target period
+  unsigned long frameMicros;  // Last frame, from the end of the wait before it to its end
+  unsigned long slackMicros;  // Time the last frame left over and slept, 0 if it was late
+};
+
+/**
+ * @brief Sets the frame period of the current scene, starting with the next frame.
+ */
+void frameSetPeriod(unsigned long periodMicros);
+
+/**
+ * @brief Returns the frame period of the current scene.
+ */
+unsigned long framePeriod();
+
+/**
+ * @brief Ends a frame: submits its drawing (renderSubmit()) and sleeps until the next is due.
+ *
+ * Called by updateControllerInput(), so input is read just after the wait. Loops that don't
+ * read the controllers call it themselves.
+ */
+void frameWait();
+
+/**
+ * @brief Shows what was drawn for a while, such as a game over screen, then starts frames afresh.
+ *
+ * Sleeps like frameWait() but isn't a frame: controllers, recordings and replays don't move on,
+ * and the pause doesn't count as a late frame.
+ */
+void framePause(unsigned long ms);
+
+/**
+ * @brief Returns the measured frame time and slack.
+ */
+const FrameStats& frameStats();
+
+#endif // FRAME_H
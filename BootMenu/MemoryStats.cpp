@@ -0,0 +1,104 @@
+// MemoryStats.cpp
+
+#include "MemoryStats.h"
+#include "Scene.h"
+
+// Tasks whose stacks are watched: loop() and the games, drawing, the SD card
+const char* const memoryTasks[] = {"loopTask", "render", "storage"};
+const int MEMORY_TASK_COUNT = sizeof(memoryTasks) / sizeof(memoryTasks[0]);
+
+// Marks a record written by this firmware, RTC memory holds noise after power-up
+const uint32_t MEMORY_STATS_MAGIC = 0x4d454d31;
+
+struct MemorySceneRecord {
+  uint32_t magic;
+  char name[MEMORY_STATS_NAME_SIZE];
+  uint32_t frames;
+  uint32_t heapLow;                      // Lowest free heap at the end of a frame
+  uint32_t blockLow;                     // Lowest largest free block, at stack checks
+  uint32_t bootHeapLow;                  // Lowest free heap since boot, from the allocator
+  uint32_t arenaUsed;                    // Most of the scene arena in use
+  int32_t stackFree[MEMORY_TASK_COUNT];  // Least free stack in bytes since the task started, -1 unknown
+};
+
+// Kept through esp_restart() so the scene a game ends with is still reported
+RTC_NOINIT_ATTR MemorySceneRecord memoryRecord;
+
+// False until the first memoryScene() of this boot. Until then a valid record is from before the
+// restart, and sampling now would mix this boot's stacks and heap into it.
+bool memoryRecordCurrent = false;
+
+// Function prototypes (private to this file)
+void memorySample(bool checkStacks);
+int32_t memoryStackFree(const char* task);
+
+// =============================================================================================================
+
+void memoryScene(const char* name) {
+  if (memoryRecord.magic == MEMORY_STATS_MAGIC) {
+    memoryRecord.name[MEMORY_STATS_NAME_SIZE - 1] = '\0';
+    if (memoryRecordCurrent) memorySample(true); // A stored record is printed as it was left
+    memoryStatsReport();
+  }
+  memoryRecordCurrent = true;
+
+  memset(&memoryRecord, 0, sizeof(memoryRecord));
+  strncpy(memoryRecord.name, name, MEMORY_STATS_NAME_SIZE - 1);
+  memoryRecord.heapLow = UINT32_MAX;
+  memoryRecord.blockLow = UINT32_MAX;
+  memorySample(true);
+  memoryRecord.magic = MEMORY_STATS_MAGIC;
+}
+
+void memoryStatsFrame() {
+  if (memoryRecord.magic != MEMORY_STATS_MAGIC) return;
+  memoryRecord.frames++;
+  memorySample(memoryRecord.frames % MEMORY_STATS_STACK_FRAMES == 0);
+}
+
+void memoryStatsReport() {
+  Serial.printf("%s memory, %lu frames:\n", memoryRecord.name, (unsigned long)memoryRecord.frames);
+  Serial.printf("  %-28s %10lu\n", "lowest free heap", (unsigned long)memoryRecord.heapLow);
+  Serial.printf("  %-28s %10lu\n", "lowest largest free block", (unsigned long)memoryRecord.blockLow);
+  Serial.printf("  %-28s %10lu\n", "lowest free heap since boot", (unsigned long)memoryRecord.bootHeapLow);
+  Serial.printf("  %-28s %10lu\n", "scene arena used", (unsigned long)memoryRecord.arenaUsed);
+  for (int i = 0; i < MEMORY_TASK_COUNT; i++) {
+    char label[32];
+    snprintf(label, sizeof(label), "least free stack, %s", memoryTasks[i]);
+    if (memoryRecord.stackFree[i] < 0) {
+      Serial.printf("  %-28s %10s\n", label, "-");
+    } else {
+      Serial.printf("  %-28s %10ld\n", label, (long)memoryRecord.stackFree[i]);
+    }
+  }
+}
+
+// =============================================================================================================
+
+void memorySample(bool checkStacks) {
+  uint32_t heap = ESP.getFreeHeap();
+  if (heap < memoryRecord.heapLow) memoryRecord.heapLow = heap;
+  if (sceneArenaUsed() > memoryRecord.arenaUsed) memoryRecord.arenaUsed = sceneArenaUsed();
+  if (!checkStacks) return;
+
+  uint32_t block = ESP.getMaxAllocHeap();
+  if (block < memoryRecord.blockLow) memoryRecord.blockLow = block;
+  memoryRecord.bootHeapLow = ESP.getMinFreeHeap();
+  for (int i = 0; i < MEMORY_TASK_COUNT; i++) {
+    memoryRecord.stackFree[i] = memoryStackFree(memoryTasks[i]);
+  }
+}
+
+#ifdef ARCADE_HOST
+// The host has no task stacks to measure
+int32_t memoryStackFree(const char* /* task */) {
+  return -1;
+}
+#else
+// ESP-IDF counts stacks in bytes. The mark only ever goes down, so the latest reading is the lowest.
+int32_t memoryStackFree(const char* task) {
+  TaskHandle_t handle = xTaskGetHandle(task);
+  if (handle == NULL) return -1;
+  return uxTaskGetStackHighWaterMark(handle);
+}
+#endif
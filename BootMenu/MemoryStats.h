@@ -0,0 +1,40 @@
+// MemoryStats.h
+//
+// Heap and stack high-water marks per scene (Scene.h): the menu, each game and demo. Every
+// frame the free heap is sampled, and every MEMORY_STATS_STACK_FRAMES frames the least free
+// stack of each task. When a scene ends its figures are printed over serial. Games end with
+// esp_restart(), so the record lives in RTC memory and the next boot prints it instead.
+//
+// The heap low is sampled at the end of frames, so memory taken and given back within one
+// frame can go unseen; the since-boot figure from the allocator catches those.
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <Arduino.h>
+
+// Frames between stack checks, which walk each task's unused stack
+const uint32_t MEMORY_STATS_STACK_FRAMES = 50;
+
+// Longest scene name kept, with its terminator
+const int MEMORY_STATS_NAME_SIZE = 16;
+
+/**
+ * @brief Ends the current scene, printing its report, and starts measuring a new one.
+ *
+ * Called by sceneBegin(). The first call after a restart prints the scene that ran before it.
+ * @param name Scene name for the report, copied.
+ */
+void memoryScene(const char* name);
+
+/**
+ * @brief Called by frameWait() at the end of every frame to take the samples.
+ */
+void memoryStatsFrame();
+
+/**
+ * @brief Prints the current scene's figures over serial.
+ */
+void memoryStatsReport();
+
+#endif // MEMORY_STATS_H
@@ -0,0 +1,199 @@
+// PerfHud.cpp
+
+#include "PerfHud.h"
+
+#ifdef PERF_HUD
+
+#include "Render.h"
+#include "ControllerInput.h"
+#include "Scene.h"
+
+extern ArcadeDisplay tft;
+
+// Overlay size: lines of text in a 3x5 font, each pixel drawn as a square of PERF_HUD_SCALE
+const int PERF_HUD_COLUMNS = 20;
+const int PERF_HUD_LINES = 3;
+const int PERF_HUD_SCALE = 2;
+const int PERF_HUD_CELL_WIDTH = 4 * PERF_HUD_SCALE;   // Glyph and a column of space
+const int PERF_HUD_CELL_HEIGHT = 6 * PERF_HUD_SCALE;  // Glyph and a row of space
+const int PERF_HUD_WIDTH = PERF_HUD_COLUMNS * PERF_HUD_CELL_WIDTH;
+const int PERF_HUD_HEIGHT = PERF_HUD_LINES * PERF_HUD_CELL_HEIGHT;
+
+// Black and white look the same whatever setSwapBytes() the game left set
+const uint16_t PERF_HUD_INK = TFT_WHITE;
+const uint16_t PERF_HUD_PAPER = TFT_BLACK;
+
+// Characters the overlay uses, 3 bits per row from the top, the leftmost pixel highest
+struct PerfHudGlyph {
+  char c;
+  uint16_t rows;
+};
+
+const PerfHudGlyph perfHudFont[] = {
+  {'0', 0b111101101101111}, {'1', 0b010110010010111}, {'2', 0b111001111100111}, {'3', 0b111001111001111},
+  {'4', 0b101101111001001}, {'5', 0b111100111001111}, {'6', 0b111100111101111}, {'7', 0b111001001001001},
+  {'8', 0b111101111101111}, {'9', 0b111101111001111}, {'.', 0b000000000000010}, {'/', 0b001001010100100},
+  {'-', 0b000000111000000}, {'A', 0b010101111101101}, {'B', 0b110101110101110}, {'E', 0b111100110100111},
+  {'F', 0b111100110100100}, {'H', 0b101101111101101}, {'I', 0b111010010010111}, {'K', 0b101101110101101},
+  {'L', 0b100100100100111}, {'M', 0b101111111101101}, {'N', 0b110101101101101}, {'P', 0b110101110100100},
+  {'S', 0b011100010001110}, {'U', 0b101101101101111}
+};
+
+bool perfHudVisible = false;
+bool perfHudCombo = false;              // M+P were held at the last frame
+
+// Frame time: the time between the ends of consecutive frames, the last PERF_HUD_SAMPLES of them
+unsigned long perfHudLastFrame = 0;
+uint32_t perfHudSamples[PERF_HUD_SAMPLES];
+int perfHudSampleCount = 0;
+int perfHudNextSample = 0;
+
+unsigned long perfHudInputSeen = 0;     // lastInputMicros of the press already measured
+unsigned long perfHudLatency = 0;       // From the last press to the end of the frame after it
+
+// Refresh window
+unsigned long perfHudWindowStart = 0;   // millis()
+uint32_t perfHudWindowFrames = 0;
+uint32_t perfHudWindowBytes = 0;        // The game's drawing this window, without the overlay's
+uint32_t perfHudBytesMark = 0;          // displayStatsTotalBytes() after the overlay last drew
+
+// The render task reads an image when it plays the list, so the two images take turns: one
+// is only written again after the list holding it has been drawn
+uint16_t perfHudImage[2][PERF_HUD_WIDTH * PERF_HUD_HEIGHT];
+int perfHudNextImage = 0;
+int perfHudShownImage = -1;             // Image on screen, pushed every frame; -1 before the first
+
+// Function prototypes (private to this file)
+void perfHudDraw(uint32_t fps, uint32_t bytesPerFrame);
+void perfHudTenths(char* text, size_t size, uint32_t tenths);
+void perfHudPrint(uint16_t* image, int line, const char* text);
+uint16_t perfHudGlyphRows(char c);
+
+// =============================================================================================================
+
+void perfHudFrame() {
+  unsigned long now = micros();
+  if (perfHudLastFrame != 0) {
+    perfHudSamples[perfHudNextSample] = now - perfHudLastFrame;
+    perfHudNextSample = (perfHudNextSample + 1) % PERF_HUD_SAMPLES;
+    if (perfHudSampleCount < PERF_HUD_SAMPLES) perfHudSampleCount++;
+  }
+  perfHudLastFrame = now;
+  perfHudWindowFrames++;
+
+  unsigned long pressed = lastInputMicros;
+  if (pressed != perfHudInputSeen) {
+    perfHudInputSeen = pressed;
+    perfHudLatency = now - pressed;
+  }
+
+  // What only the game would have sent this frame, before the overlay's image below
+  perfHudWindowBytes += displayStatsTotalBytes() - perfHudBytesMark;
+
+  bool combo = mButton == 0 && pButton == 0;
+  if (combo && !perfHudCombo) {
+    perfHudVisible = !perfHudVisible;
+    if (!perfHudVisible) {
+      // Only the scene knows what was under the overlay, so it draws its screen again
+      perfHudShownImage = -1;
+      sceneRequestRepaint();
+    }
+  }
+  perfHudCombo = combo;
+
+  unsigned long elapsed = millis() - perfHudWindowStart;
+  if (elapsed >= PERF_HUD_REFRESH_MS) {
+    if (perfHudVisible) {
+      perfHudDraw(perfHudWindowFrames * 1000 / elapsed, perfHudWindowBytes / perfHudWindowFrames);
+    }
+    perfHudWindowStart = millis();
+    perfHudWindowFrames = 0;
+    perfHudWindowBytes = 0;
+  }
+
+  // Pushed again every frame, after the game's drawing, so nothing the game redraws covers it
+  if (perfHudVisible && perfHudShownImage >= 0) {
+    tft.pushImage(0, tft.height() - PERF_HUD_HEIGHT, PERF_HUD_WIDTH, PERF_HUD_HEIGHT, perfHudImage[perfHudShownImage]);
+  }
+  perfHudBytesMark = displayStatsTotalBytes();
+}
+
+// =============================================================================================================
+
+void perfHudDraw(uint32_t fps, uint32_t bytesPerFrame) {
+  // Percentiles from a sorted copy, insertion sort is plenty for this many
+  uint32_t sorted[PERF_HUD_SAMPLES];
+  int count = perfHudSampleCount;
+  for (int i = 0; i < count; i++) {
+    uint32_t sample = perfHudSamples[i];
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > sample; j--) sorted[j] = sorted[j - 1];
+    sorted[j] = sample;
+  }
+  uint32_t p50 = count > 0 ? sorted[count / 2] / 100 : 0;            // Tenths of a millisecond
+  uint32_t p99 = count > 0 ? sorted[count * 99 / 100] / 100 : 0;
+
+  // Each figure is capped so the widest line, e.g. "FPS 999 MS 99.9/9999", is PERF_HUD_COLUMNS
+  // long. The buffers have room for anything the formats could produce, which keeps
+  // -Wformat-truncation quiet.
+  char line[48];
+  char median[12];
+  char slowest[12];
+  char bus[12];
+  uint16_t* image = perfHudImage[perfHudNextImage];
+  perfHudShownImage = perfHudNextImage;
+  perfHudNextImage = 1 - perfHudNextImage;
+
+  perfHudTenths(median, sizeof(median), p50);
+  perfHudTenths(slowest, sizeof(slowest), p99);
+  snprintf(line, sizeof(line), "FPS %lu MS %s/%s", (unsigned long)min<uint32_t>(fps, 999), median, slowest);
+  perfHudPrint(image, 0, line);
+
+  perfHudTenths(bus, sizeof(bus), bytesPerFrame * 10 / 1024);
+  if (perfHudInputSeen != 0) {
+    snprintf(line, sizeof(line), "IN %luMS BUS %sK/F", min<unsigned long>(perfHudLatency / 1000, 999), bus);
+  } else {
+    snprintf(line, sizeof(line), "IN - BUS %sK/F", bus);
+  }
+  perfHudPrint(image, 1, line);
+
+  snprintf(line, sizeof(line), "HEAP %luK BLK %luK", (unsigned long)min<uint32_t>(ESP.getFreeHeap() / 1024, 999),
+           (unsigned long)min<uint32_t>(ESP.getMaxAllocHeap() / 1024, 999));
+  perfHudPrint(image, 2, line);
+}
+
+// A figure in tenths as at most 4 characters: "12.3" below 100, then whole units up to 9999
+void perfHudTenths(char* text, size_t size, uint32_t tenths) {
+  if (tenths < 1000) {
+    snprintf(text, size, "%lu.%lu", (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+  } else {
+    snprintf(text, size, "%lu", (unsigned long)min<uint32_t>(tenths / 10, 9999));
+  }
+}
+
+// Writes a line of text across the image, blank past its end
+void perfHudPrint(uint16_t* image, int line, const char* text) {
+  int length = strlen(text);
+  for (int column = 0; column < PERF_HUD_COLUMNS; column++) {
+    uint16_t rows = column < length ? perfHudGlyphRows(text[column]) : 0;
+    for (int y = 0; y < PERF_HUD_CELL_HEIGHT; y++) {
+      int row = y / PERF_HUD_SCALE;
+      uint16_t* pixel = &image[(line * PERF_HUD_CELL_HEIGHT + y) * PERF_HUD_WIDTH + column * PERF_HUD_CELL_WIDTH];
+      for (int x = 0; x < PERF_HUD_CELL_WIDTH; x++) {
+        int dot = x / PERF_HUD_SCALE;
+        bool ink = dot < 3 && row < 5 && (rows >> (14 - row * 3 - dot)) & 1;
+        pixel[x] = ink ? PERF_HUD_INK : PERF_HUD_PAPER;
+      }
+    }
+  }
+}
+
+// Characters missing from the font come out blank
+uint16_t perfHudGlyphRows(char c) {
+  for (unsigned int i = 0; i < sizeof(perfHudFont) / sizeof(perfHudFont[0]); i++) {
+    if (perfHudFont[i].c == c) return perfHudFont[i].rows;
+  }
+  return 0;
+}
+
+#endif // PERF_HUD
@@ -0,0 +1,42 @@
+// PerfHud.h
+//
+// Performance overlay for finding out why a cabinet is slow without a serial cable. Pressing
+// M and P together on controller 1 shows or hides, in the bottom left corner: frames per
+// second, frame time (median and 99th percentile of the last PERF_HUD_SAMPLES frames), the
+// latency of the last button press, display bus bytes per frame, and the free heap with its
+// largest free block.
+//
+// Define PERF_HUD to build it in, here or with -DPERF_HUD; release builds leave it out.
+
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include <Arduino.h>
+
+// #define PERF_HUD
+
+#ifdef PERF_HUD
+
+// Frames the frame time percentiles are taken over
+const int PERF_HUD_SAMPLES = 128;
+
+// How often the figures are redrawn
+const unsigned long PERF_HUD_REFRESH_MS = 250;
+
+/**
+ * @brief Called by frameWait() at the end of every frame, before the frame is submitted.
+ *
+ * Takes the measurements, handles M+P, and redraws the overlay when it is due. The overlay
+ * is one image pushed to its own corner after the game's drawing, once a frame so the game
+ * never draws over it; its bytes are left out of the bytes per frame it shows. Hiding it asks
+ * the scene to draw its whole screen again (sceneRequestRepaint()).
+ */
+void perfHudFrame();
+
+#else
+
+inline void perfHudFrame() {}
+
+#endif // PERF_HUD
+
+#endif // PERF_HUD_H
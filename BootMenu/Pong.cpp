@@ -2,17 +2,66 @@
 #include <Arduino.h>
 #include <esp_system.h>
 #include "Pong.h"
+#include "Scores.h"
+#include "Render.h"
+#include "Replay.h"
+#include "Frame.h"
+#include "Scene.h"
 
-extern TFT_eSPI tft;
-extern int paused;
-extern int isPauseButtonPressed();
+extern ArcadeDisplay tft;
+extern bool paused;
 
 // Global variables
 Paddle player1, player2;
 Ball ball;
 int player1Score = 0, player2Score = 0;
+int rallyHits = 0;    // Paddle hits since the last serve
+int longestRally = 0; // Best rally of the match, kept on the leaderboard
 int selectedOption = 0;
 
+// Bounce directions (cos, sin) for the 8 zones of a paddle, top to bottom: -60 to +60 degrees
+const fixed BOUNCE_COS[8] = {32768, 46341, 56756, 63302, 63302, 56756, 46341, 32768};
+const fixed BOUNCE_SIN[8] = {-56756, -46341, -32768, -16962, 16962, 32768, 46341, 56756};
+
+// State at the start of the current physics step, for interpolation
+Ball prevBall;
+fixed prevPlayer1Y, prevPlayer2Y;
+
+// Timing of the fixed step loop
+unsigned long pongLastMicros = 0;
+unsigned long pongAccumulator = 0;
+
+// What is on screen now, -1 when it has to be drawn from scratch
+int drawnBallX = -1, drawnBallY = -1;
+int drawnPlayer1Y = -1, drawnPlayer2Y = -1;
+int drawnPlayer1Score = -1, drawnPlayer2Score = -1;
+
+// Player 2 is a person when pongMode is 0, otherwise the CPU at level pongMode - 1
+const CpuLevel CPU_LEVEL[CPU_LEVELS] = {
+  {"Easy", 30, PER_SECOND(120), 44},
+  {"Normal", 15, PER_SECOND(200), 36},
+  {"Hard", 6, PER_SECOND(300), 10},
+};
+int pongMode = 0;
+
+// Where the CPU is heading, refreshed once per bounce rather than every frame
+fixed cpuTargetY;
+int cpuWaitSteps = 0;
+
+// Pause menu entries
+const int PAUSE_OPTIONS = 4;
+
+// Button states seen by the previous pongLoop(), for edge detection
+int lastPauseState = 1, lastUpState = 1, lastDownState = 1, lastAState = 1;
+
+// The game over screen is up and needs no redrawing
+bool gameOverShown = false;
+
+void resetBall();
+void pongRedraw();
+void pongDrawGameOver();
+void predictIntercept();
+
 // =============================================================================================================
 
 // debounce vars
@@ -23,208 +72,391 @@ unsigned long p2LastDownTime = 0;
 
 // =============================================================================================================
 
+// Draws one pause menu entry, red when selected, over whatever that line showed before
+void drawPauseOption(int option) {
+  const int y = SCREEN_HEIGHT / 2 - 25 + option * 25;
+  tft.fillRect(SCREEN_WIDTH / 4, y, SCREEN_WIDTH / 2 + 40, 16, TFT_BLACK);
+  tft.setTextSize(2);
+  tft.setTextColor(option == selectedOption ? TFT_RED : TFT_WHITE);
+  tft.setCursor(SCREEN_WIDTH / 4, y);
+  switch (option) {
+    case 0: tft.print("Resume Game?"); break;
+    case 1: tft.print("Restart Game?"); break;
+    case 2:
+      tft.print("Mode: ");
+      tft.print(pongMode == 0 ? "2 Players" : CPU_LEVEL[pongMode - 1].name);
+      break;
+    case 3: tft.print("Return to menu?"); break;
+  }
+  tft.setTextColor(TFT_WHITE);
+}
+
+// Drawn once when the game pauses, afterwards only changed entries are redrawn
 void drawPauseMenu() {
   tft.fillScreen(TFT_BLACK);
+  tft.setTextSize(2);
   tft.setTextColor(TFT_WHITE); // reset colour
   tft.setCursor(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 80);
-  tft.println("GAME PAUSED");
-
-  if (selectedOption == 0) {
-    tft.setTextColor(TFT_RED);
-  }
-  tft.setCursor(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 40);
-  tft.println("Resume Game?");
+  tft.print("GAME PAUSED");
 
-  tft.setTextColor(TFT_WHITE); // reset colour
-  if (selectedOption == 1) {
-    tft.setTextColor(TFT_RED);
+  for (int option = 0; option < PAUSE_OPTIONS; option++) {
+    drawPauseOption(option);
   }
-  tft.setCursor(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2);
-  tft.println("Restart Game?");
-
-  tft.setTextColor(TFT_WHITE); // reset colour
-  if (selectedOption == 2) {
-    tft.setTextColor(TFT_RED);
-  }
-  tft.setCursor(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 + 40);
-  tft.println("Return to menu?");
-
-  tft.setTextColor(TFT_WHITE);
-  
-  // small delay to reduce flickering
-  delay(20);
 }
 
 // =============================================================================================================
 
-void handlePauseMenu() {
+// True only on the call where the button goes from released to pressed
+bool pressedEdge(int current, int& last) {
+  bool pressed = last == 1 && current == 0;
+  last = current;
+  return pressed;
+}
+
+void handlePauseMenu(bool upPressed, bool downPressed, bool aPressed) {
   // using up down buttons to navigate pause menu
-  if (upButton == 1) {
-    selectedOption = (selectedOption + 1) % 3;
-    delay(100); // debounce
+  int previous = selectedOption;
+  if (upPressed) {
+    selectedOption = (selectedOption - 1 + PAUSE_OPTIONS) % PAUSE_OPTIONS;
+  }
+  if (downPressed) {
+    selectedOption = (selectedOption + 1) % PAUSE_OPTIONS;
   }
-  if (downButton == 1) {
-    selectedOption = (selectedOption - 1 + 3) % 3;
-    delay(100); // debounce
+  if (selectedOption != previous) {
+    drawPauseOption(previous);
+    drawPauseOption(selectedOption);
   }
 
-  static int lastAState = 1;
-  int currAState = aButton;
-  if (lastAState == 1 && currAState == 0) {
-    delay(100);
+  if (aPressed) {
     // Check what is currently selected
         if (selectedOption == 0) { // Resume Game
-            paused = 0;
+            paused = false;
+            pongRedraw();
         } else if (selectedOption == 1) { // Restart Game
             pongSetup(); // Reset the game
-            paused = 0;
-        } else if (selectedOption == 2) { // Return to Boot Menu
+            paused = false;
+        } else if (selectedOption == 2) { // Switch between 2 players and the CPU levels
+            pongMode = (pongMode + 1) % (CPU_LEVELS + 1);
+            predictIntercept();
+            drawPauseOption(selectedOption);
+        } else if (selectedOption == 3) { // Return to Boot Menu
             esp_restart();
         }
   }
-  lastAState = currAState;
 }
 
 // =============================================================================================================
 
 void gameOver() {
+  if ((player1Score == 10 || player2Score == 10) && !gameOverShown) {
+    gameOverShown = true;
+
+    // The longest rally of the match goes on the leaderboard
+    recordGamePlayed(LEADERBOARD_PONG, longestRally);
+    if (longestRally > 0 && scoreQualifies(LEADERBOARD_PONG, longestRally)) {
+      insertNewScore(LEADERBOARD_PONG, longestRally);
+    }
+
+    pongDrawGameOver();
+  }
+}
+
+void pongDrawGameOver() {
   int scrWidth = tft.width();
   int scrHeight = tft.height();
 
   String gameOver = "GAME OVER";
-  String winnerText = (player1Score == 10) ? "Player 1 Wins!!!" : "Player 2 Wins!!!";
+  String winnerText = (player1Score == 10) ? "Player 1 Wins!!!" : (pongMode == 0) ? "Player 2 Wins!!!" : "CPU Wins!!!";
 
-  if (player1Score == 10 || player2Score == 10) {
-    tft.fillScreen(TFT_BLACK);
+  tft.fillScreen(TFT_BLACK);
 
-    // calc centered pos of text
-    int gameOverX = (scrWidth - tft.textWidth(gameOver)) / 2;
-    int winTextX = (scrWidth - tft.textWidth(winnerText)) / 2;
+  // calc centered pos of text
+  int gameOverX = (scrWidth - tft.textWidth(gameOver)) / 2;
+  int winTextX = (scrWidth - tft.textWidth(winnerText)) / 2;
 
-    // game over text
-    tft.drawString(gameOver, gameOverX, scrHeight / 2);
+  // game over text
+  tft.drawString(gameOver, gameOverX, scrHeight / 2);
 
-    // winners text 10 pixels below
-    tft.drawString(winnerText, winTextX, (scrHeight / 2) + 20);
-  }
+  // winners text 10 pixels below
+  tft.drawString(winnerText, winTextX, (scrHeight / 2) + 20);
 }
 // =============================================================================================================
 
 void pongSetup() {
     tft.setRotation(1); // sideways
+    frameSetPeriod(PONG_STEP_US); // One physics step per frame, as in recordings and replays
 
     
     player1Score = 0;
     player2Score = 0;
+    longestRally = 0;
+    gameOverShown = false;
 
     player1.x = 10;
-    player1.y = SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2;
+    player1.y = INT_TO_FIX(SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2);
 
     player2.x = SCREEN_WIDTH - 20;
-    player2.y = SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2;
+    player2.y = INT_TO_FIX(SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2);
+    prevPlayer1Y = player1.y;
+    prevPlayer2Y = player2.y;
 
-    ball.x = SCREEN_WIDTH / 2;
-    ball.y = SCREEN_HEIGHT / 2;
-    ball.dx = 4; // Ball speed in x direction
-    ball.dy = 4; // Ball speed in y direction
+    resetBall();
+
+    pongLastMicros = replayMicros();
+    pongAccumulator = 0;
+    pongRedraw();
 }
 
-// =============================================================================================================
+// Clears the screen and forgets what was drawn, the next pongDraw() draws everything
+void pongRedraw() {
+    tft.fillScreen(TFT_BLACK);
+    drawnBallX = drawnBallY = -1;
+    drawnPlayer1Y = drawnPlayer2Y = -1;
+    drawnPlayer1Score = drawnPlayer2Score = -1;
+}
 
-void pongDraw() {
-    // Clear only the paddle areas
-    tft.fillRect(player1.x, player1.y, PADDLE_WIDTH, PADDLE_HEIGHT, TFT_BLACK); // Erase previous paddle position
-    tft.fillRect(player2.x, player2.y, PADDLE_WIDTH, PADDLE_HEIGHT, TFT_BLACK); // Erase previous paddle position
+// =============================================================================================================
 
-    // Draw paddles in the new positions
-    tft.fillRect(player1.x, player1.y, PADDLE_WIDTH, PADDLE_HEIGHT, TFT_WHITE);
-    tft.fillRect(player2.x, player2.y, PADDLE_WIDTH, PADDLE_HEIGHT, TFT_WHITE);
+bool rectsOverlap(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2) {
+    return x1 < x2 + w2 && x2 < x1 + w1 && y1 < y2 + h2 && y2 < y1 + h1;
+}
 
-    // Clear only the ball area
-    tft.fillRect(ball.x, ball.y, BALL_SIZE, BALL_SIZE, TFT_BLACK); // Erase previous ball position
-    
-    // Draw ball in the new position
-    tft.fillRect(ball.x, ball.y, BALL_SIZE, BALL_SIZE, TFT_WHITE);
+// Moves a paddle on screen by drawing only the strips it uncovers and covers
+void drawPaddle(int x, int y, int& drawnY, bool force) {
+    if (drawnY < 0 || force || abs(y - drawnY) >= PADDLE_HEIGHT) {
+        if (drawnY >= 0 && y != drawnY) tft.fillRect(x, drawnY, PADDLE_WIDTH, PADDLE_HEIGHT, TFT_BLACK);
+        tft.fillRect(x, y, PADDLE_WIDTH, PADDLE_HEIGHT, TFT_WHITE);
+    } else if (y > drawnY) {
+        tft.fillRect(x, drawnY, PADDLE_WIDTH, y - drawnY, TFT_BLACK);
+        tft.fillRect(x, drawnY + PADDLE_HEIGHT, PADDLE_WIDTH, y - drawnY, TFT_WHITE);
+    } else if (y < drawnY) {
+        tft.fillRect(x, y + PADDLE_HEIGHT, PADDLE_WIDTH, drawnY - y, TFT_BLACK);
+        tft.fillRect(x, y, PADDLE_WIDTH, drawnY - y, TFT_WHITE);
+    }
+    drawnY = y;
+}
 
-    // Draw scores without clearing the entire screen
+void drawScore(int x, int score, int& drawnScore, bool force) {
+    if (score == drawnScore && !force) return;
+    tft.fillRect(x, 10, 36, 16, TFT_BLACK); // Room for three digits at size 2
     tft.setTextColor(TFT_WHITE);
     tft.setTextSize(2);
-    tft.setCursor(SCREEN_WIDTH / 4, 10);
-    tft.print(player1Score);
-    tft.setCursor(3 * SCREEN_WIDTH / 4, 10);
-    tft.print(player2Score);
+    tft.setCursor(x, 10);
+    tft.print(score);
+    drawnScore = score;
+}
+
+// Draws the game 'alpha' (Q16, 0..1) of the way from the previous physics step to the
+// current one, touching only what moved since the last frame
+void pongDraw(fixed alpha) {
+    int p1y = FIX_TO_INT(prevPlayer1Y + FIX_MUL(player1.y - prevPlayer1Y, alpha));
+    int p2y = FIX_TO_INT(prevPlayer2Y + FIX_MUL(player2.y - prevPlayer2Y, alpha));
+    int ballX = FIX_TO_INT(prevBall.x + FIX_MUL(ball.x - prevBall.x, alpha));
+    int ballY = FIX_TO_INT(prevBall.y + FIX_MUL(ball.y - prevBall.y, alpha));
+    bool ballMoved = ballX != drawnBallX || ballY != drawnBallY;
+
+    // Erase the ball where it was, repairing anything the erase cut into
+    bool repair1 = false, repair2 = false, repairScores = false;
+    if (ballMoved && drawnBallX >= 0) {
+        tft.fillRect(drawnBallX, drawnBallY, BALL_SIZE, BALL_SIZE, TFT_BLACK);
+        repair1 = rectsOverlap(drawnBallX, drawnBallY, BALL_SIZE, BALL_SIZE, player1.x, p1y, PADDLE_WIDTH, PADDLE_HEIGHT);
+        repair2 = rectsOverlap(drawnBallX, drawnBallY, BALL_SIZE, BALL_SIZE, player2.x, p2y, PADDLE_WIDTH, PADDLE_HEIGHT);
+        repairScores = drawnBallY < 26;
+    }
+
+    drawPaddle(player1.x, p1y, drawnPlayer1Y, repair1);
+    drawPaddle(player2.x, p2y, drawnPlayer2Y, repair2);
+
+    // Draw scores without clearing the entire screen
+    drawScore(SCREEN_WIDTH / 4, player1Score, drawnPlayer1Score, repairScores);
+    drawScore(3 * SCREEN_WIDTH / 4, player2Score, drawnPlayer2Score, repairScores);
+
+    // Draw ball in the new position, last so nothing above erases it
+    if (ballMoved || repairScores) {
+        tft.fillRect(ballX, ballY, BALL_SIZE, BALL_SIZE, TFT_WHITE);
+        drawnBallX = ballX;
+        drawnBallY = ballY;
+    }
 }
 
 // =============================================================================================================
 
 void resetBall() {
-  ball.x = SCREEN_WIDTH / 2;
-  ball.y = SCREEN_HEIGHT / 2;
-  ball.dx = 4; // Ball speed in x direction
-  ball.dy = 4; // Ball speed in y direction
+  ball.x = INT_TO_FIX(SCREEN_WIDTH / 2);
+  ball.y = INT_TO_FIX(SCREEN_HEIGHT / 2);
+  ball.speed = BALL_SPEED_START;
+  rallyHits = 0;
+  ball.dx = FIX_MUL(ball.speed, BOUNCE_COS[6]); // Serve down and right at 45 degrees
+  ball.dy = FIX_MUL(ball.speed, BOUNCE_SIN[6]);
+  prevBall = ball; // Jump straight to the centre rather than sliding there
+  predictIntercept();
 }
 
 // =============================================================================================================
 
+// Sends the ball back from a paddle: the further from the centre it hits, the steeper the
+// angle, and every hit of a rally makes it faster
+void bounceOffPaddle(const Paddle& paddle, int direction) {
+  fixed offset = ball.y + INT_TO_FIX(BALL_SIZE) - paddle.y; // 0 .. PADDLE_HEIGHT + BALL_SIZE
+  int zone = (int)(((int64_t)offset * 8) / INT_TO_FIX(PADDLE_HEIGHT + BALL_SIZE));
+  zone = constrain(zone, 0, 7);
+
+  rallyHits++;
+  longestRally = max(longestRally, rallyHits);
+
+  ball.speed = min(ball.speed + BALL_SPEED_STEP, BALL_SPEED_MAX);
+  ball.dx = direction * FIX_MUL(ball.speed, BOUNCE_COS[zone]);
+  ball.dy = FIX_MUL(ball.speed, BOUNCE_SIN[zone]);
+  predictIntercept();
+}
+
+// Works out where the ball will reach player 2, folding the straight-line path back into the
+// court for every wall bounce on the way, so nothing needs recomputing until the next paddle hit
+void predictIntercept() {
+  if (pongMode == 0) return;
+  const CpuLevel& level = CPU_LEVEL[pongMode - 1];
+  cpuWaitSteps = level.reactionSteps;
+
+  if (ball.dx <= 0) {
+    // Ball heading away: drift back to the middle
+    cpuTargetY = INT_TO_FIX(SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2);
+    return;
+  }
+
+  fixed steps = FIX_DIV(INT_TO_FIX(player2.x - BALL_SIZE) - ball.x, ball.dx);
+  int64_t y = ball.y + (((int64_t)ball.dy * steps) >> 16);
+  const int64_t bottom = INT_TO_FIX(SCREEN_HEIGHT - BALL_SIZE);
+  y %= 2 * bottom;
+  if (y < 0) y += 2 * bottom;
+  if (y > bottom) y = 2 * bottom - y;
+
+  int error = replayRandom(-level.errorPixels, level.errorPixels + 1);
+  cpuTargetY = (fixed)y + INT_TO_FIX(BALL_SIZE / 2 - PADDLE_HEIGHT / 2 + error);
+}
+
+// Moves the CPU paddle one physics step towards its target, no faster than its level allows
+void moveCpuPaddle() {
+  if (cpuWaitSteps > 0) {
+    cpuWaitSteps--;
+    return;
+  }
+  const CpuLevel& level = CPU_LEVEL[pongMode - 1];
+  fixed move = constrain(cpuTargetY - player2.y, -level.maxSpeed, level.maxSpeed);
+  player2.y = constrain(player2.y + move, 0, INT_TO_FIX(SCREEN_HEIGHT - PADDLE_HEIGHT));
+}
+
+// True if the ball, moving from fromX to ball.x this update, crossed faceX at the height of the
+// paddle. Sweeping the path instead of testing the end position stops fast balls tunnelling.
+bool sweptHit(const Paddle& paddle, fixed fromX, fixed fromY, fixed faceX) {
+  fixed travelled = ball.x - fromX;
+  if (travelled == 0) return false;
+  fixed t = FIX_DIV(faceX - fromX, travelled);
+  if (t < 0 || t > FIX_ONE) return false;
+
+  fixed hitY = fromY + FIX_MUL(ball.y - fromY, t);
+  if (hitY + INT_TO_FIX(BALL_SIZE) < paddle.y || hitY > paddle.y + INT_TO_FIX(PADDLE_HEIGHT)) return false;
+
+  ball.x = faceX;
+  ball.y = hitY;
+  return true;
+}
+
+// =============================================================================================================
+
+// Moves a paddle one physics step, -1 up, 1 down
+void movePaddle(Paddle& paddle, int direction) {
+  paddle.y = constrain(paddle.y + direction * PADDLE_SPEED, 0, INT_TO_FIX(SCREEN_HEIGHT - PADDLE_HEIGHT));
+}
+
+// =============================================================================================================
+
+// Advances the game by one fixed physics step
 void pongUpdate() {
     if (!paused) {
-        // Update ball position
+      prevBall = ball;
+      prevPlayer1Y = player1.y;
+      prevPlayer2Y = player2.y;
+
+      // Read inputs for paddles
+      movePaddle(player1, (downButton == 0) - (upButton == 0));
+      if (pongMode == 0) {
+        movePaddle(player2, (downButton2 == 0) - (upButton2 == 0));
+      } else {
+        moveCpuPaddle();
+      }
+
+      fixed fromX = ball.x;
+      fixed fromY = ball.y;
+
+      // Update ball position
       ball.x += ball.dx;
       ball.y += ball.dy;
 
-      // Ball collision with top and bottom
-      if (ball.y <= 0 || ball.y >= SCREEN_HEIGHT - BALL_SIZE) {
-          ball.dy *= -1;
-      }
-
-      // Ball collision with paddles
+      // Ball collision with paddles, along the path travelled this update
       if (ball.dx < 0) {  // Ball moving left
-          if (ball.x <= player1.x + PADDLE_WIDTH && ball.y + BALL_SIZE >= player1.y && ball.y <= player1.y + PADDLE_HEIGHT) {
-              ball.dx *= -1;
-              ball.x = player1.x + PADDLE_WIDTH; // Ensure ball is outside the paddle after bounce
+          if (sweptHit(player1, fromX, fromY, INT_TO_FIX(player1.x + PADDLE_WIDTH))) {
+              bounceOffPaddle(player1, 1);
           } else if (ball.x < 0) {  // If ball gets behind player1
               player2Score++;
               resetBall(); // Reset after scoring
               return;
           }
       } else if (ball.dx > 0) {  // Ball moving right
-          if (ball.x + BALL_SIZE >= player2.x && ball.y + BALL_SIZE >= player2.y && ball.y <= player2.y + PADDLE_HEIGHT) {
-              ball.dx *= -1;
-              ball.x = player2.x - BALL_SIZE; // Ensure ball is outside the paddle after bounce
-          } else if (ball.x > SCREEN_WIDTH - BALL_SIZE) {  // If ball gets behind player2
+          if (sweptHit(player2, fromX, fromY, INT_TO_FIX(player2.x - BALL_SIZE))) {
+              bounceOffPaddle(player2, -1);
+          } else if (ball.x > INT_TO_FIX(SCREEN_WIDTH - BALL_SIZE)) {  // If ball gets behind player2
               player1Score++;
               resetBall(); // Reset after scoring
               return;
           }
       }
 
-      // Ball out of bounds
-      if (ball.x < 0) {
-          player2Score++;
-          resetBall(); // Reset
-      } else if (ball.x > SCREEN_WIDTH - BALL_SIZE) {
-          player1Score++;
-          resetBall(); // Reset
-    }
+      // Ball collision with top and bottom, reflecting whatever went past the wall
+      const fixed bottom = INT_TO_FIX(SCREEN_HEIGHT - BALL_SIZE);
+      if (ball.y < 0) {
+          ball.y = -ball.y;
+          ball.dy = -ball.dy;
+      } else if (ball.y > bottom) {
+          ball.y = 2 * bottom - ball.y;
+          ball.dy = -ball.dy;
+      }
   }
 }
 
 // =============================================================================================================
 
 void pongLoop() {
-  static unsigned long lastUpdateTime = 0;
-  unsigned long currentTime = millis();
-  unsigned long elapsedTime = currentTime - lastUpdateTime;
-
-  if (isPauseButtonPressed()) {
-    delay(200);
-    if (paused == 1) {
-      paused = 0;} else {paused = 1;}
+  unsigned long currentTime = replayMicros();
+  unsigned long elapsedTime = currentTime - pongLastMicros;
+  pongLastMicros = currentTime;
+
+  // Edges are tracked every call so a button held across a pause toggle fires once
+  bool pausePressed = pressedEdge(pauseButton, lastPauseState);
+  bool upPressed = pressedEdge(upButton, lastUpState);
+  bool downPressed = pressedEdge(downButton, lastDownState);
+  bool aPressed = pressedEdge(aButton, lastAState);
+
+  // Whichever screen is up is drawn from scratch
+  if (sceneRepaintRequested()) {
+    if (paused) {
+      drawPauseMenu();
+    } else if (gameOverShown) {
+      pongDrawGameOver();
+    } else {
+      pongRedraw();
+    }
   }
 
-  if (paused == 1) {
-    drawPauseMenu();
-    handlePauseMenu();
+  if (pausePressed) {
+    paused = !paused;
+    if (paused) {
+      selectedOption = 0;
+      drawPauseMenu();
+    } else {
+      pongRedraw();
+    }
+  } else if (paused) {
+    handlePauseMenu(upPressed, downPressed, aPressed);
   } else {
     
     // game over check
@@ -233,33 +465,16 @@ void pongLoop() {
       return; // stops loop
     }
 
-    // Read inputs for paddles
-    if (downButton == 1) {
-        if (player1.y > 0) {  // Check upper bound
-            player1.y -= 6;   // Move up
-        }
-    }
-    if (upButton == 1) {
-        if (player1.y < SCREEN_HEIGHT - PADDLE_HEIGHT) { // Check lower bound
-            player1.y += 6;   // Move down
-        }
-    }
-    if (downButton2 == 1) {
-        if (player2.y > 0) {  // Check upper bound
-            player2.y -= 6;   // Move up
-        }
-    }
-    if (upButton2 == 1) {
-        if (player2.y < SCREEN_HEIGHT - PADDLE_HEIGHT) { // Check lower bound
-            player2.y += 6;   // Move down
-        }
+    // Run as many physics steps as real time has passed, so drawing speed changes
+    // smoothness but not game speed
+    pongAccumulator += min(elapsedTime, PONG_MAX_FRAME_US);
+    while (pongAccumulator >= PONG_STEP_US) {
+      pongUpdate();
+      pongAccumulator -= PONG_STEP_US;
     }
 
-    pongUpdate();
-    tft.fillScreen(TFT_BLACK);
-    pongDraw();
+    pongDraw((fixed)((pongAccumulator << 16) / PONG_STEP_US));
   }
-  delay(20);
 }
 
 // =============================================================================================================
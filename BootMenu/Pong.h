@@ -12,6 +12,26 @@ const int PADDLE_HEIGHT = 60;
 // ball size
 const int BALL_SIZE = 8;
 
+// Q16.16 fixed point, so physics is integer-only and identical on every build
+typedef int32_t fixed;
+#define FIX_ONE ((fixed)1 << 16)
+#define INT_TO_FIX(i) ((fixed)(i) * FIX_ONE)
+#define FIX_TO_INT(f) ((int)((f) >> 16))
+#define FIX_MUL(a, b) ((fixed)(((int64_t)(a) * (b)) >> 16))
+#define FIX_DIV(a, b) ((fixed)(((int64_t)(a) << 16) / (b)))
+
+// physics runs in fixed steps whatever the frame rate, rendering interpolates between them
+const int PONG_STEPS_PER_SECOND = 100;
+const unsigned long PONG_STEP_US = 1000000UL / PONG_STEPS_PER_SECOND;
+const unsigned long PONG_MAX_FRAME_US = 100000; // longer stalls are dropped, not caught up
+
+// speeds in pixels per second, stored per physics step
+#define PER_SECOND(pixels) (INT_TO_FIX(pixels) / PONG_STEPS_PER_SECOND)
+const fixed PADDLE_SPEED = PER_SECOND(300);
+const fixed BALL_SPEED_START = PER_SECOND(200);  // raised on every paddle hit of a rally
+const fixed BALL_SPEED_STEP = PER_SECOND(25) / 2;
+const fixed BALL_SPEED_MAX = PER_SECOND(500);
+
 // Define button pins
 extern int upButton; // same as bootmenu
 extern int downButton; // same as bootmenu
@@ -21,13 +41,25 @@ extern int aButton;
 extern int aButton2;
 extern int pauseButton;
 
+// CPU opponent for player 2, one entry per difficulty
+struct CpuLevel {
+    const char* name;
+    int reactionSteps;   // physics steps between a bounce and the CPU starting to move
+    fixed maxSpeed;      // per physics step
+    int errorPixels;     // the CPU aims up to this far off the predicted intercept
+};
+
+const int CPU_LEVELS = 3;
+
 // Declare variables
 struct Paddle {
-    int x, y;
+    int x;      // fixed column
+    fixed y;
 };
 
 struct Ball {
-    int x, y, dx, dy;
+    fixed x, y, dx, dy;
+    fixed speed;  // length of (dx, dy)
 };
 
 void pongSetup();
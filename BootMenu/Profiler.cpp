@@ -0,0 +1,48 @@
+// Profiler.cpp
+
+#include "Profiler.h"
+
+// One finished stage
+struct ProfileStage {
+  const char* name;
+  unsigned long endMicros;
+};
+
+const char* profileSection = "";
+unsigned long profileOrigin = 0;
+ProfileStage profileStages[PROFILE_MAX_STAGES];
+int profileStageCount = 0;
+
+// =============================================================================================================
+
+void profileStart(const char* section, unsigned long origin) {
+  profileSection = section;
+  profileOrigin = origin;
+  profileStageCount = 0;
+}
+
+void profileStart(const char* section) {
+  profileStart(section, micros());
+}
+
+void profileMark(const char* stage) {
+  unsigned long now = micros();
+  if (profileStageCount < PROFILE_MAX_STAGES) {
+    profileStages[profileStageCount].name = stage;
+    profileStages[profileStageCount].endMicros = now;
+    profileStageCount++;
+  }
+}
+
+void profileReport() {
+  Serial.printf("%s profile:\n", profileSection);
+  Serial.printf("  %-28s %10s %10s\n", "stage", "start ms", "took us");
+
+  unsigned long start = profileOrigin;
+  for (int i = 0; i < profileStageCount; i++) {
+    const ProfileStage& stage = profileStages[i];
+    Serial.printf("  %-28s %10lu %10lu\n", stage.name, (start - profileOrigin) / 1000, stage.endMicros - start);
+    start = stage.endMicros;
+  }
+  Serial.printf("  %-28s %10s %10lu\n", "total", "", start - profileOrigin);
+}
@@ -0,0 +1,36 @@
+// Profiler.h
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Stages remembered per section, later marks are dropped
+const int PROFILE_MAX_STAGES = 16;
+
+/**
+ * @brief Starts timing a section such as boot or a game launch, forgetting earlier marks.
+ *
+ * @param section Name printed above the table. Must outlive the report (use a literal).
+ * @param origin micros() the first stage is measured from. Boot passes 0 to include the
+ *               time from reset to setup().
+ */
+void profileStart(const char* section, unsigned long origin);
+void profileStart(const char* section);
+
+/**
+ * @brief Records that a stage of the current section ended now.
+ *
+ * Each stage lasts from the previous mark (or the origin) until this call. Drawing only goes
+ * into the display list (Render.h), so a stage that draws calls renderFinish() first to
+ * include the panel's work.
+ * @param stage Name of the stage. Must outlive the report (use a literal).
+ */
+void profileMark(const char* stage);
+
+/**
+ * @brief Prints the current section as a table over serial: stage, start and duration.
+ */
+void profileReport();
+
+#endif // PROFILER_H
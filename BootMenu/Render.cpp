@@ -0,0 +1,184 @@
+// Render.cpp
+
+#include "Render.h"
+
+// A frame's drawing calls, written by the game task and played by the render task
+struct RenderList {
+  RenderCommand commands[RENDER_MAX_COMMANDS];
+  int count;
+  char text[RENDER_TEXT_BYTES];
+  int textLength;
+};
+
+// Double buffer: the game task only writes renderLists[renderFill], the render task only reads
+// the list in renderPending. Handing a list over is a single store, nothing is locked.
+RenderList renderLists[2];
+int renderFill = 0;
+int renderPending = -1;   // List given to the render task and not yet drawn, or -1
+
+// Draws for the render task. tft only records, so their settings never get in each other's way.
+TFT_eSPI renderPanel = TFT_eSPI();
+
+bool renderStarted = false;
+#ifndef ARCADE_HOST
+TaskHandle_t renderTaskHandle = NULL;
+TaskHandle_t renderGameTask = NULL;   // Woken when a list has been drawn
+#endif
+
+// Function prototypes (private to this file)
+RenderCommand* renderReserve(int textBytes);
+void renderPlay(const RenderList& list);
+void renderWaitIdle();
+void renderTask(void* parameter);
+
+// =============================================================================================================
+
+void renderBegin() {
+  if (renderStarted) return;
+  renderStarted = true;
+#ifndef ARCADE_HOST
+  renderGameTask = xTaskGetCurrentTaskHandle();
+  // Core 0 with the Wi-Fi stack, leaving core 1 to loop() and the games. Above the storage task,
+  // which spends its time waiting for the card.
+  xTaskCreatePinnedToCore(renderTask, "render", 4096, NULL, 2, &renderTaskHandle, 0);
+#endif
+}
+
+void renderSubmit() {
+  RenderList& list = renderLists[renderFill];
+  if (list.count == 0) return;
+
+#ifndef ARCADE_HOST
+  if (renderStarted) {
+    // The other list is free once the panel has finished it, usually long before
+    renderWaitIdle();
+    __atomic_store_n(&renderPending, renderFill, __ATOMIC_RELEASE);
+    xTaskNotifyGive(renderTaskHandle);
+    renderFill = 1 - renderFill;
+    renderLists[renderFill].count = 0;
+    renderLists[renderFill].textLength = 0;
+    return;
+  }
+#endif
+
+  // No task yet, or the host: draw it here. The list is switched first, so a host run stopped
+  // part way through drawing leaves a clean list behind.
+  renderFill = 1 - renderFill;
+  renderLists[renderFill].count = 0;
+  renderLists[renderFill].textLength = 0;
+  renderPlay(list);
+}
+
+void renderFinish() {
+  renderSubmit();
+#ifndef ARCADE_HOST
+  if (renderStarted) renderWaitIdle();
+#endif
+}
+
+// A free command, with room for text after the list's text. A full list is submitted early,
+// the frame just reaches the panel in two parts.
+RenderCommand* renderReserve(int textBytes) {
+  if (renderLists[renderFill].count == RENDER_MAX_COMMANDS ||
+      renderLists[renderFill].textLength + textBytes > RENDER_TEXT_BYTES) {
+    renderSubmit();
+  }
+  RenderList& list = renderLists[renderFill];
+  RenderCommand* command = &list.commands[list.count++];
+  command->font = 0;
+  command->data = NULL;
+  return command;
+}
+
+void renderAdd(RenderOp op, uint32_t color, int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f) {
+  RenderCommand* command = renderReserve(0);
+  command->op = op;
+  command->color = color;
+  command->value[0] = a;
+  command->value[1] = b;
+  command->value[2] = c;
+  command->value[3] = d;
+  command->value[4] = e;
+  command->value[5] = f;
+}
+
+void renderAddImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  renderAdd(RENDER_PUSH_IMAGE, 0, x, y, w, h);
+  renderLists[renderFill].commands[renderLists[renderFill].count - 1].data = data;
+}
+
+// Text longer than a whole list is cut short
+void renderAddText(RenderOp op, const char* text, int32_t x, int32_t y, uint8_t font) {
+  int length = min((int)strlen(text), RENDER_TEXT_BYTES - 1);
+  RenderCommand* command = renderReserve(length + 1);
+  RenderList& list = renderLists[renderFill];
+  char* copy = &list.text[list.textLength];
+  memcpy(copy, text, length);
+  copy[length] = '\0';
+  list.textLength += length + 1;
+
+  command->op = op;
+  command->font = font;
+  command->color = 0;
+  command->value[0] = x;
+  command->value[1] = y;
+  command->data = copy;
+}
+
+// =============================================================================================================
+
+void renderPlay(const RenderList& list) {
+  for (int i = 0; i < list.count; i++) {
+    const RenderCommand& command = list.commands[i];
+    const int16_t* v = command.value;
+    const char* text = (const char*)command.data;
+    switch (command.op) {
+      case RENDER_INIT: renderPanel.init(); break;
+      case RENDER_ROTATION: renderPanel.setRotation(v[0]); break;
+      case RENDER_SWAP_BYTES: renderPanel.setSwapBytes(v[0] != 0); break;
+      case RENDER_TEXT_SIZE: renderPanel.setTextSize(v[0]); break;
+      case RENDER_TEXT_COLOR: renderPanel.setTextColor(command.color); break;
+      case RENDER_TEXT_COLORS: renderPanel.setTextColor(command.color, (uint16_t)v[0]); break;
+      case RENDER_TEXT_DATUM: renderPanel.setTextDatum(v[0]); break;
+      case RENDER_CURSOR: renderPanel.setCursor(v[0], v[1]); break;
+      case RENDER_FILL_SCREEN: renderPanel.fillScreen(command.color); break;
+      case RENDER_FILL_RECT: renderPanel.fillRect(v[0], v[1], v[2], v[3], command.color); break;
+      case RENDER_DRAW_RECT: renderPanel.drawRect(v[0], v[1], v[2], v[3], command.color); break;
+      case RENDER_DRAW_LINE: renderPanel.drawLine(v[0], v[1], v[2], v[3], command.color); break;
+      case RENDER_FILL_CIRCLE: renderPanel.fillCircle(v[0], v[1], v[2], command.color); break;
+      case RENDER_FILL_TRIANGLE: renderPanel.fillTriangle(v[0], v[1], v[2], v[3], v[4], v[5], command.color); break;
+      case RENDER_PUSH_IMAGE: renderPanel.pushImage(v[0], v[1], v[2], v[3], (const uint16_t*)command.data); break;
+      case RENDER_DRAW_STRING:
+        if (command.font == 0) {
+          renderPanel.drawString(text, v[0], v[1]);
+        } else {
+          renderPanel.drawString(text, v[0], v[1], command.font);
+        }
+        break;
+      case RENDER_DRAW_CENTRE_STRING: renderPanel.drawCentreString(text, v[0], v[1], command.font); break;
+      case RENDER_PRINT: renderPanel.print(text); break;
+    }
+  }
+}
+
+#ifndef ARCADE_HOST
+// Blocks until the render task has drawn the pending list. It notifies this task after clearing
+// renderPending, so a notification taken early, or one from the frame timer, just means looking
+// again; one that arrived before the wait leaves the count up and the take returns at once.
+void renderWaitIdle() {
+  while (__atomic_load_n(&renderPending, __ATOMIC_ACQUIRE) != -1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+void renderTask(void* parameter) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int index = __atomic_load_n(&renderPending, __ATOMIC_ACQUIRE);
+    if (index < 0) continue;
+    renderPlay(renderLists[index]);
+    __atomic_store_n(&renderPending, -1, __ATOMIC_RELEASE);
+    xTaskNotifyGive(renderGameTask);
+  }
+}
+#endif
@@ -0,0 +1,228 @@
+// Render.h
+//
+// Drawing on the other core. Games draw on tft as before, but the calls are only written
+// down in a display list. renderSubmit() hands the finished list to a task on core 0, which
+// plays it to the panel while the game works out the next frame on core 1. There are two
+// lists, so the game only waits if the panel is still busy with the frame before.
+//
+// On the host there is no task: a list is played as soon as it is submitted, so runs repeat
+// exactly.
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <TFT_eSPI.h>
+#include "DisplayStats.h"
+
+// Drawing calls per list, a frame with more is sent in parts
+const int RENDER_MAX_COMMANDS = 512;
+
+// Bytes of text per list, terminators included
+const int RENDER_TEXT_BYTES = 1024;
+
+// TFT_eSPI calls a list can hold
+enum RenderOp {
+  RENDER_INIT,
+  RENDER_ROTATION,
+  RENDER_SWAP_BYTES,
+  RENDER_TEXT_SIZE,
+  RENDER_TEXT_COLOR,
+  RENDER_TEXT_COLORS,       // Text colour with a background
+  RENDER_TEXT_DATUM,
+  RENDER_CURSOR,
+  RENDER_FILL_SCREEN,
+  RENDER_FILL_RECT,
+  RENDER_DRAW_RECT,
+  RENDER_DRAW_LINE,
+  RENDER_FILL_CIRCLE,
+  RENDER_FILL_TRIANGLE,
+  RENDER_PUSH_IMAGE,
+  RENDER_DRAW_STRING,
+  RENDER_DRAW_CENTRE_STRING,
+  RENDER_PRINT
+};
+
+struct RenderCommand {
+  uint8_t op;
+  uint8_t font;        // 0 for drawString() without a font
+  uint16_t color;
+  int16_t value[6];    // Coordinates and sizes in call order, or the setting
+  const void* data;    // Image pixels, or text in the list
+};
+
+/**
+ * @brief Starts the render task. Lists submitted before are drawn by the game task.
+ *
+ * Call from the task that draws (loop()'s), which is the one woken when the panel catches up.
+ */
+void renderBegin();
+
+/**
+ * @brief Ends the frame: the calls made since the last submit go to the panel.
+ *
+ * Returns at once unless the panel is still drawing the previous list. Called by frameWait()
+ * and framePause().
+ */
+void renderSubmit();
+
+/**
+ * @brief Submits the frame and waits until the panel has drawn it.
+ *
+ * For memory the lists point into, such as images, before it is freed or reused.
+ */
+void renderFinish();
+
+/**
+ * @brief Adds a setting or shape to the list. Called by ArcadeDisplay, not by games.
+ */
+void renderAdd(RenderOp op, uint32_t color, int32_t a = 0, int32_t b = 0, int32_t c = 0, int32_t d = 0,
+               int32_t e = 0, int32_t f = 0);
+
+/**
+ * @brief Adds an image. The pixels are read when the list is played, so they must not change
+ *        until then (use constant images).
+ */
+void renderAddImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+
+/**
+ * @brief Adds a text call, copying the text into the list.
+ */
+void renderAddText(RenderOp op, const char* text, int32_t x = 0, int32_t y = 0, uint8_t font = 0);
+
+// What the games draw on. Drawing calls and the settings they use go into the display list;
+// text settings also apply here, so textWidth() and fontHeight() answer as before. Nothing
+// called on this object touches the bus. A drawing call that isn't shadowed here would draw
+// from the game task, so shadow any new call the games start using.
+class ArcadeDisplay : public TFT_eSPI {
+ public:
+  void init() {
+    renderAdd(RENDER_INIT, 0);
+  }
+
+  void setRotation(uint8_t rotation) {
+    listRotation = rotation;
+    renderAdd(RENDER_ROTATION, 0, rotation);
+  }
+
+  // Portrait for even rotations as on the ST7789, without asking the panel
+  int16_t width() const {
+    return (listRotation & 1) ? TFT_HEIGHT : TFT_WIDTH;
+  }
+
+  int16_t height() const {
+    return (listRotation & 1) ? TFT_WIDTH : TFT_HEIGHT;
+  }
+
+  void setSwapBytes(bool swap) {
+    renderAdd(RENDER_SWAP_BYTES, 0, swap);
+  }
+
+  void setTextSize(uint8_t size) {
+    TFT_eSPI::setTextSize(size);
+    renderAdd(RENDER_TEXT_SIZE, 0, size);
+  }
+
+  void setTextColor(uint16_t color) {
+    TFT_eSPI::setTextColor(color);
+    renderAdd(RENDER_TEXT_COLOR, color);
+  }
+
+  void setTextColor(uint16_t color, uint16_t background) {
+    TFT_eSPI::setTextColor(color, background);
+    renderAdd(RENDER_TEXT_COLORS, color, background);
+  }
+
+  void setTextDatum(uint8_t datum) {
+    TFT_eSPI::setTextDatum(datum);
+    renderAdd(RENDER_TEXT_DATUM, 0, datum);
+  }
+
+  void setCursor(int16_t x, int16_t y) {
+    renderAdd(RENDER_CURSOR, 0, x, y);
+  }
+
+  void fillScreen(uint32_t color DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT((uint32_t)width() * height());
+    renderAdd(RENDER_FILL_SCREEN, color);
+  }
+
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT(clippedArea(x, y, w, h));
+    renderAdd(RENDER_FILL_RECT, color, x, y, w, h);
+  }
+
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT(w > 0 && h > 0 ? 2 * (w + h) - 4 : 0);
+    renderAdd(RENDER_DRAW_RECT, color, x, y, w, h);
+  }
+
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT(max(abs(x1 - x0), abs(y1 - y0)) + 1);
+    renderAdd(RENDER_DRAW_LINE, color, x0, y0, x1, y1);
+  }
+
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT((uint32_t)((2 * r + 1) * (2 * r + 1)) * 201 / 256); // pi / 4 of the box
+    renderAdd(RENDER_FILL_CIRCLE, color, x, y, r);
+  }
+
+  void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                    uint32_t color DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT(abs((x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0)) / 2);
+    renderAdd(RENDER_FILL_TRIANGLE, color, x0, y0, x1, y1, x2, y2);
+  }
+
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT(clippedArea(x, y, w, h));
+    renderAddImage(x, y, w, h, data);
+  }
+
+  int16_t drawString(const String& string, int32_t x, int32_t y DISPLAY_STATS_SITE) {
+    int16_t w = textWidth(string);
+    DISPLAY_STATS_COUNT((uint32_t)w * fontHeight());
+    renderAddText(RENDER_DRAW_STRING, string.c_str(), x, y);
+    return w;
+  }
+
+  int16_t drawString(const String& string, int32_t x, int32_t y, uint8_t font DISPLAY_STATS_SITE) {
+    int16_t w = textWidth(string);
+    DISPLAY_STATS_COUNT((uint32_t)w * fontHeight(font));
+    renderAddText(RENDER_DRAW_STRING, string.c_str(), x, y, font);
+    return w;
+  }
+
+  int16_t drawCentreString(const String& string, int32_t x, int32_t y, uint8_t font DISPLAY_STATS_SITE) {
+    int16_t w = textWidth(string);
+    DISPLAY_STATS_COUNT((uint32_t)w * fontHeight(font));
+    renderAddText(RENDER_DRAW_CENTRE_STRING, string.c_str(), x, y, font);
+    return w;
+  }
+
+  // At the cursor, which only the render task keeps
+  size_t print(const char* text DISPLAY_STATS_SITE) {
+    DISPLAY_STATS_COUNT((uint32_t)textWidth(text) * fontHeight());
+    renderAddText(RENDER_PRINT, text);
+    return strlen(text);
+  }
+
+  // Formatted on the stack, so printing a number never touches the heap
+  size_t print(long value DISPLAY_STATS_SITE) {
+    char text[12];
+    snprintf(text, sizeof(text), "%ld", value);
+    DISPLAY_STATS_COUNT((uint32_t)textWidth(text) * fontHeight());
+    renderAddText(RENDER_PRINT, text);
+    return strlen(text);
+  }
+
+ private:
+  uint32_t clippedArea(int32_t x, int32_t y, int32_t w, int32_t h) {
+    int32_t right = min<int32_t>(x + w, width()), bottom = min<int32_t>(y + h, height());
+    x = max<int32_t>(x, 0);
+    y = max<int32_t>(y, 0);
+    return (right > x && bottom > y) ? (uint32_t)(right - x) * (bottom - y) : 0;
+  }
+
+  uint8_t listRotation = 0;
+};
+
+#endif // RENDER_H
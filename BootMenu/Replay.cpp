@@ -0,0 +1,244 @@
+// Replay.cpp
+
+#include "Replay.h"
+#include <SD.h>
+#include "ControllerInput.h"
+#include "Storage.h"
+
+// A packet of a recording
+struct ReplayEvent {
+  uint32_t frame;
+  uint8_t controller;
+  uint16_t mask;
+};
+
+uint32_t replayRandomState = 1;
+
+volatile ReplayMode replayState = REPLAY_OFF;
+uint32_t replayFrameCount = 0;
+unsigned long replayVirtualMicros = 0;
+
+// Recording: the newest packet of each controller, set by the ESP-NOW callback
+volatile uint16_t replayHeldMask[MAX_CONTROLLERS + 1];
+uint16_t replayAppliedMask[MAX_CONTROLLERS + 1];
+
+// Playback, filled in by replayLoad() on the storage task. The table only exists from
+// replayStartPlayback() until the replay ends or has applied its last packet, so it costs
+// no RAM the rest of the time.
+ReplayEvent* replayEvents = NULL;
+int replayEventCount = 0;
+int replayNextEvent = 0;
+int replayLoadedGame = -1;
+uint32_t replayLoadedSeed = 0;
+
+// Function prototypes (private to this file)
+void replayBegin(ReplayMode mode, uint32_t seed);
+void replayLogPacket(int controllerNumber, uint16_t mask);
+void replayLoad();
+void replayFreeEvents();
+bool replayParseLine(const char* line, bool header);
+
+// =============================================================================================================
+
+// xorshift32: small, and the same on every compiler, unlike random() on the ESP32 and the host
+void replayRandomSeed(uint32_t seed) {
+  replayRandomState = seed != 0 ? seed : 1;
+}
+
+long replayRandom(long howbig) {
+  if (howbig <= 0) return 0;
+  replayRandomState ^= replayRandomState << 13;
+  replayRandomState ^= replayRandomState >> 17;
+  replayRandomState ^= replayRandomState << 5;
+  return replayRandomState % (uint32_t)howbig;
+}
+
+long replayRandom(long howmin, long howmax) {
+  if (howmin >= howmax) return howmin;
+  return howmin + replayRandom(howmax - howmin);
+}
+
+unsigned long replayMicros() {
+  return replayState == REPLAY_OFF ? micros() : replayVirtualMicros;
+}
+
+unsigned long replayMillis() {
+  return replayMicros() / 1000;
+}
+
+ReplayMode replayMode() {
+  return replayState;
+}
+
+// =============================================================================================================
+
+void replayStartRecording(int game) {
+  uint32_t seed = micros();
+  char header[48];
+  int length = snprintf(header, sizeof(header), "REPLAY %d %d %lu\n", REPLAY_VERSION, game, (unsigned long)seed);
+  if (!storageReady()) {
+    Serial.println("No SD card, the recording won't be saved");
+  }
+  storageWriteFile(REPLAY_PATH, (const uint8_t*)header, length);
+
+  replayBegin(REPLAY_RECORDING, seed);
+  // Buttons held at the start, usually A and X from the menu, are frame 0
+  for (int c = 1; c <= MAX_CONTROLLERS; c++) {
+    replayAppliedMask[c] = buttonMask(c);
+    replayHeldMask[c] = replayAppliedMask[c];
+    replayLogPacket(c, replayAppliedMask[c]);
+  }
+  Serial.printf("Recording game %d, seed %lu\n", game, (unsigned long)seed);
+}
+
+int replayStartPlayback() {
+  replayLoadedGame = -1;
+  replayFreeEvents();
+  replayEvents = (ReplayEvent*)malloc(REPLAY_MAX_EVENTS * sizeof(ReplayEvent));
+  if (replayEvents == NULL) {
+    Serial.println("Not enough memory to replay");
+    return -1;
+  }
+  uint32_t ticket = storageCall(replayLoad);
+  if (ticket == 0) {
+    replayFreeEvents();
+    return -1;
+  }
+  while (!storageComplete(ticket)) {
+    delay(10);
+  }
+  if (replayLoadedGame < 0) {
+    Serial.println("No replay on the SD card");
+    replayFreeEvents();
+    return -1;
+  }
+
+  replayBegin(REPLAY_PLAYING, replayLoadedSeed);
+  while (replayNextEvent < replayEventCount && replayEvents[replayNextEvent].frame == 0) {
+    applyButtonMask(replayEvents[replayNextEvent].controller, replayEvents[replayNextEvent].mask);
+    replayNextEvent++;
+  }
+  Serial.printf("Replaying game %d, seed %lu, %d packets\n", replayLoadedGame, (unsigned long)replayLoadedSeed,
+                replayEventCount);
+  return replayLoadedGame;
+}
+
+void replayBegin(ReplayMode mode, uint32_t seed) {
+  replayRandomSeed(seed);
+  replayFrameCount = 0;
+  replayVirtualMicros = 0;
+  replayNextEvent = 0;
+  replayState = mode;
+}
+
+bool replayTakePacket(int controllerNumber, uint16_t mask) {
+  if (replayState == REPLAY_RECORDING) {
+    replayHeldMask[controllerNumber] = mask;
+    return true;
+  }
+  if (replayState == REPLAY_PLAYING) {
+    if ((mask & BUTTONS_RELEASED) == BUTTONS_RELEASED) return true; // Letting go of Y+A isn't taking over
+    Serial.println("Replay ended by controller input");
+    replayState = REPLAY_OFF;
+  }
+  return false;
+}
+
+void replayFrame() {
+  if (replayState == REPLAY_OFF) {
+    // A button press ended the replay. Freed here, the callback can't while a frame reads the table.
+    if (replayEvents != NULL) replayFreeEvents();
+    return;
+  }
+  replayFrameCount++;
+  replayVirtualMicros += REPLAY_FRAME_MICROS;
+
+  if (replayState == REPLAY_RECORDING) {
+    for (int c = 1; c <= MAX_CONTROLLERS; c++) {
+      uint16_t mask = replayHeldMask[c];
+      if (mask != replayAppliedMask[c]) {
+        applyButtonMask(c, mask);
+        replayAppliedMask[c] = mask;
+        replayLogPacket(c, mask);
+      }
+    }
+  } else {
+    while (replayNextEvent < replayEventCount && replayEvents[replayNextEvent].frame <= replayFrameCount) {
+      applyButtonMask(replayEvents[replayNextEvent].controller, replayEvents[replayNextEvent].mask);
+      replayNextEvent++;
+    }
+    if (replayNextEvent == replayEventCount) replayFreeEvents(); // The clock runs on without them
+  }
+}
+
+void replayFreeEvents() {
+  free(replayEvents);
+  replayEvents = NULL;
+  replayEventCount = 0;
+  replayNextEvent = 0;
+}
+
+void replayLogPacket(int controllerNumber, uint16_t mask) {
+  char line[32];
+  snprintf(line, sizeof(line), "%lu %d %x", (unsigned long)replayFrameCount, controllerNumber, mask);
+  storageAppendLine(REPLAY_PATH, line);
+}
+
+// =============================================================================================================
+
+// Runs on the storage task. replayLoadedGame stays -1 unless the whole file reads.
+void replayLoad() {
+  File file = SD.open(REPLAY_PATH, FILE_READ);
+  if (!file) return;
+
+  char line[48];
+  int length = 0;
+  bool header = true;
+  bool ok = true;
+  replayEventCount = 0;
+  while (ok) {
+    int c = file.read();
+    if (c == '\n' || c < 0) {
+      line[length] = '\0';
+      if (length > 0) {
+        ok = replayParseLine(line, header);
+        header = false;
+      }
+      length = 0;
+      if (c < 0) break;
+    } else if (length < (int)sizeof(line) - 1) {
+      line[length++] = (char)c;
+    }
+  }
+  file.close();
+
+  if (!ok || header) {
+    replayLoadedGame = -1;
+    Serial.println("Replay file is damaged");
+  } else if (replayEventCount == REPLAY_MAX_EVENTS) {
+    Serial.println("Replay too long, packets past REPLAY_MAX_EVENTS are dropped");
+  }
+}
+
+bool replayParseLine(const char* line, bool header) {
+  if (header) {
+    int version, game;
+    unsigned long seed;
+    if (sscanf(line, "REPLAY %d %d %lu", &version, &game, &seed) != 3 || version != REPLAY_VERSION) return false;
+    replayLoadedGame = game;
+    replayLoadedSeed = seed;
+    return true;
+  }
+
+  unsigned long frame;
+  int controller;
+  unsigned int mask;
+  if (sscanf(line, "%lu %d %x", &frame, &controller, &mask) != 3) return false;
+  if (controller < 1 || controller > MAX_CONTROLLERS) return false;
+  if (replayEventCount == REPLAY_MAX_EVENTS) return true; // Reported once the file is read
+  replayEvents[replayEventCount].frame = frame;
+  replayEvents[replayEventCount].controller = controller;
+  replayEvents[replayEventCount].mask = mask;
+  replayEventCount++;
+  return true;
+}
@@ -0,0 +1,100 @@
+// Replay.h
+//
+// Recording and replaying game sessions. A recording is the random seed plus every controller
+// packet, stamped with the frame it took effect in. While recording or replaying, packets only
+// take effect at frame boundaries (updateControllerInput()) and game time is a virtual clock
+// that moves on REPLAY_FRAME_MICROS per frame, so nothing depends on when a packet happened to
+// arrive or how long drawing took, and a replay draws the same frames on the device and the host.
+//
+// Games take time and random numbers from here rather than micros() and random(). Outside a
+// session these are the real clock and a seeded generator.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <Arduino.h>
+
+// Text file on the SD card: a "REPLAY <version> <game> <seed>" line, then
+// "<frame> <controller> <mask in hex>" per packet
+const char* const REPLAY_PATH = "/replay.log";
+const int REPLAY_VERSION = 1;
+
+// Virtual time per frame while recording or replaying. Pong's frame period (one physics step),
+// so Pong plays at its normal speed.
+const unsigned long REPLAY_FRAME_MICROS = 10000;
+
+// Packets a replay can hold, later ones are dropped with a warning. The table (8 bytes a packet)
+// comes from the heap for the replay only.
+const int REPLAY_MAX_EVENTS = 2048;
+
+enum ReplayMode {
+  REPLAY_OFF,
+  REPLAY_RECORDING,
+  REPLAY_PLAYING
+};
+
+/**
+ * @brief Seeds replayRandom(). A seed of 0 is treated as 1.
+ */
+void replayRandomSeed(uint32_t seed);
+
+/**
+ * @brief Random number in [0, howbig), like random(). Same sequence on the device and the host.
+ */
+long replayRandom(long howbig);
+
+/**
+ * @brief Random number in [howmin, howmax), like random().
+ */
+long replayRandom(long howmin, long howmax);
+
+/**
+ * @brief Game time: micros(), or the virtual clock during a recording or replay.
+ */
+unsigned long replayMicros();
+
+/**
+ * @brief Game time in milliseconds, see replayMicros().
+ */
+unsigned long replayMillis();
+
+/**
+ * @brief Returns whether a session is being recorded, replayed or neither.
+ */
+ReplayMode replayMode();
+
+/**
+ * @brief Starts recording a session of a game, writing the header to REPLAY_PATH.
+ *
+ * Reseeds replayRandom() and starts the virtual clock, so call it just before launching.
+ * @param game Menu index of the game, handed back by replayStartPlayback().
+ */
+void replayStartRecording(int game);
+
+/**
+ * @brief Reads REPLAY_PATH and starts replaying it. Waits for the SD card task.
+ *
+ * Reseeds replayRandom(), starts the virtual clock and applies the button states the
+ * recording started with.
+ * @return Menu index of the recorded game to launch, or -1 if there is no readable recording.
+ */
+int replayStartPlayback();
+
+/**
+ * @brief Offers a controller packet to the session. Called from the ESP-NOW callback.
+ *
+ * While recording, the packet is held for the next frame. During a replay, packets are
+ * dropped until a button is pressed, which ends the replay and hands the game over.
+ * @return true if the packet was taken, false if it should be applied as usual.
+ */
+bool replayTakePacket(int controllerNumber, uint16_t mask);
+
+/**
+ * @brief Frame boundary: applies held or replayed packets and moves the virtual clock on.
+ *
+ * Called through updateControllerInput(), after the frame has waited out its period.
+ * Does nothing outside a session.
+ */
+void replayFrame();
+
+#endif // REPLAY_H
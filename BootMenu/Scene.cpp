@@ -0,0 +1,115 @@
+// Scene.cpp
+
+#include "Scene.h"
+#include "Render.h"
+#include "MemoryStats.h"
+#ifndef ARCADE_HOST
+#include <esp_heap_caps.h>
+#endif
+
+// A state of the current scene
+struct SceneStateEntry {
+  void* owner;                  // The state's pointer, a T**
+  void (*release)(void* owner); // sceneRelease<T>
+  void* heap;                   // Memory to free after the release, NULL in the arena
+};
+
+alignas(16) uint8_t sceneArena[SCENE_ARENA_BYTES];
+size_t sceneArenaTop = 0;       // Bytes of the arena handed out this scene
+
+SceneStateEntry sceneStates[SCENE_MAX_STATES];
+int sceneStateCount = 0;
+
+bool sceneRepaint = false;      // sceneRequestRepaint() since the scene last looked
+
+// Function prototypes (private to this file)
+[[noreturn]] void sceneFail(const char* reason, size_t size);
+void* sceneHeapAllocate(size_t size, size_t align, SceneMemory memory);
+void sceneHeapFree(void* memory);
+
+// =============================================================================================================
+
+void sceneBegin(const char* name) {
+  renderFinish();
+  for (int i = sceneStateCount - 1; i >= 0; i--) {
+    sceneStates[i].release(sceneStates[i].owner);
+    if (sceneStates[i].heap != NULL) sceneHeapFree(sceneStates[i].heap);
+  }
+  sceneStateCount = 0;
+  sceneArenaTop = 0;
+  sceneRepaint = false;
+  memoryScene(name);
+}
+
+void sceneRequestRepaint() {
+  sceneRepaint = true;
+}
+
+bool sceneRepaintRequested() {
+  bool requested = sceneRepaint;
+  sceneRepaint = false;
+  return requested;
+}
+
+size_t sceneArenaUsed() {
+  return sceneArenaTop;
+}
+
+void* sceneAllocate(size_t size, size_t align, SceneMemory memory, void* owner, void (*release)(void* owner)) {
+  if (sceneStateCount == SCENE_MAX_STATES) {
+    // A state that isn't registered would outlive the scene, and the next would use it unconstructed
+    sceneFail("more than SCENE_MAX_STATES states", size);
+  }
+
+  void* heap = memory == SCENE_PSRAM ? sceneHeapAllocate(size, align, SCENE_PSRAM) : NULL;
+  void* storage = heap;
+  if (storage == NULL) {
+    size_t start = (sceneArenaTop + align - 1) & ~(align - 1);
+    if (start + size <= SCENE_ARENA_BYTES) {
+      storage = &sceneArena[start];
+      sceneArenaTop = start + size;
+    } else {
+      Serial.printf("Scene: arena full, %u bytes from the heap\n", (unsigned)size);
+      heap = sceneHeapAllocate(size, align, SCENE_INTERNAL);
+      storage = heap;
+      if (storage == NULL) sceneFail("out of memory", size);
+    }
+  }
+
+  SceneStateEntry& entry = sceneStates[sceneStateCount++];
+  entry.owner = owner;
+  entry.release = release;
+  entry.heap = heap;
+  return storage;
+}
+
+// A game can't run without its state: says why over serial and stops, which on the chip
+// prints a backtrace and reboots
+void sceneFail(const char* reason, size_t size) {
+  Serial.printf("Scene: %s, can't place a state of %u bytes\n", reason, (unsigned)size);
+  abort();
+}
+
+// =============================================================================================================
+
+#ifdef ARCADE_HOST
+// No PSRAM on the host. aligned_alloc() wants the size a multiple of the alignment.
+void* sceneHeapAllocate(size_t size, size_t align, SceneMemory memory) {
+  if (memory == SCENE_PSRAM) return NULL;
+  return aligned_alloc(align, (size + align - 1) & ~(align - 1));
+}
+
+void sceneHeapFree(void* memory) {
+  free(memory);
+}
+#else
+// NULL for PSRAM when the board has none
+void* sceneHeapAllocate(size_t size, size_t align, SceneMemory memory) {
+  uint32_t caps = memory == SCENE_PSRAM ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  return heap_caps_aligned_alloc(align, size, caps);
+}
+
+void sceneHeapFree(void* memory) {
+  heap_caps_free(memory);
+}
+#endif
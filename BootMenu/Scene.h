@@ -0,0 +1,94 @@
+// Scene.h
+//
+// One scene runs at a time: the menu, the scoreboard, a game, or one of the attract mode's
+// demos. A game keeps its large state (fields, images, search tables) in a struct that exists
+// only while its scene runs, constructed in an arena shared by all the scenes. Peak RAM for
+// game state is then the largest game's, not the sum of them all. Starting a scene destroys
+// the states of the one before.
+//
+//   struct SnakeState { uint16_t body[gridCells]; ... };
+//   SnakeState* snake = NULL;
+//   void snakeSetup() { sceneState(snake); ... snake->body[0] = ...; }
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <Arduino.h>
+#include <new>
+
+// Internal RAM shared by the scenes, enough for the largest: Snake with its autoplayer
+const size_t SCENE_ARENA_BYTES = 6144;
+
+// States a scene can hold, a game and its autoplayer
+const int SCENE_MAX_STATES = 4;
+
+// Where a state would like to live
+enum SceneMemory {
+  SCENE_INTERNAL,   // The arena: fast, and safe to hand to the panel's DMA
+  SCENE_PSRAM       // External PSRAM, plenty of it but slower. The arena when none is fitted.
+};
+
+/**
+ * @brief Ends the current scene and starts another.
+ *
+ * Waits for the panel to finish drawing, as the display list may point into a state, then
+ * destroys the current scene's states in reverse order and sets their pointers back to NULL.
+ * Also starts the scene's memory report (memoryScene()).
+ * @param name Scene name for the memory report, copied.
+ */
+void sceneBegin(const char* name);
+
+/**
+ * @brief Asks the current scene to draw its whole screen again, e.g. when an overlay
+ *        (PerfHud.h) that covered part of it goes away.
+ */
+void sceneRequestRepaint();
+
+/**
+ * @brief True once after sceneRequestRepaint(), for the scene's loop to redraw everything.
+ *
+ * Each scene checks it where it knows what its screen shows: the game, its pause menu or its
+ * game over screen. A new scene draws from scratch anyway, so sceneBegin() drops the request.
+ */
+bool sceneRepaintRequested();
+
+/**
+ * @brief Bytes of the arena the current scene uses.
+ */
+size_t sceneArenaUsed();
+
+/**
+ * @brief Memory for a state, released with the scene. Use sceneState() rather than this.
+ *
+ * A state that doesn't fit the arena comes from the heap instead, with a warning over serial.
+ * Never returns NULL: when the heap is out of memory too, or the scene already holds
+ * SCENE_MAX_STATES, it says so over serial and aborts.
+ */
+void* sceneAllocate(size_t size, size_t align, SceneMemory memory, void* owner, void (*release)(void* owner));
+
+// Destroys a state and clears the pointer to it, called by sceneBegin()
+template <typename T>
+void sceneRelease(void* owner) {
+  T*& state = *static_cast<T**>(owner);
+  state->~T();
+  state = NULL;
+}
+
+/**
+ * @brief Makes sure the current scene has a T, constructing one (value-initialized, so zeroed
+ *        like a global) the first time.
+ *
+ * Setup functions call it on every restart of their game; within a scene the state is kept.
+ * @param state Pointer the state is reached through, set here and cleared when the scene ends.
+ */
+template <typename T>
+T* sceneState(T*& state, SceneMemory memory = SCENE_INTERNAL) {
+  static_assert(sizeof(T) <= SCENE_ARENA_BYTES, "State larger than the scene arena");
+  if (state == NULL) {
+    void* storage = sceneAllocate(sizeof(T), alignof(T), memory, &state, sceneRelease<T>);
+    state = new (storage) T();
+  }
+  return state;
+}
+
+#endif // SCENE_H
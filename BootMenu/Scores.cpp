@@ -0,0 +1,251 @@
+// Scores.cpp
+
+#include "Scores.h"
+#include "Storage.h"
+#include "Replay.h"
+#include <SD.h>
+
+// Games keeping records, indexed by LeaderboardId
+const LeaderboardInfo LEADERBOARDS[LEADERBOARD_COUNT] = {
+  {"Tetris", "pts", HIGHEST_FIRST, 5},
+  {"Pong", "hits", HIGHEST_FIRST, 3},   // Longest rally
+  {"Snake", "pts", HIGHEST_FIRST, 5},
+  {"Chess", "moves", LOWEST_FIRST, 3},  // Quickest checkmate
+};
+
+const char* SCORE_FILE = "/scores.bin";
+const char* SCORE_TEMP_FILE = "/scores.bin.tmp"; // Left by an interrupted save
+const char* STATS_FILE = "/stats.csv";
+
+// Score file layout (little-endian, as stored by the ESP32):
+//   header   magic "SCRS", uint16 version, uint16 section count
+//   sections uint8 id, uint8 entry count, uint16 reserved, then count x { char name[4], int32 score }
+//   footer   uint32 CRC-32 of everything above
+const uint32_t SCORE_FILE_MAGIC = 0x53524353; // "SCRS"
+const uint16_t SCORE_FILE_VERSION = 2;
+const int SCORE_HEADER_SIZE = 8;
+const int SCORE_SECTION_HEADER_SIZE = 4;
+const int SCORE_RECORD_SIZE = SCORE_NAME_SIZE + 4;
+const int SCORE_FILE_MAX_SIZE = SCORE_HEADER_SIZE
+    + LEADERBOARD_COUNT * (SCORE_SECTION_HEADER_SIZE + MAX_LEADERBOARD_SIZE * SCORE_RECORD_SIZE) + 4;
+static_assert(SCORE_FILE_MAX_SIZE <= STORAGE_MAX_DATA, "score file must fit in one storage request");
+
+Leaderboard leaderboards[LEADERBOARD_COUNT];
+volatile bool leaderboardsLoaded = false; // Set by the storage task once the tables are filled in
+
+// Function prototypes (private to this file)
+uint32_t scoreCrc32(const uint8_t* data, size_t length);
+void putU16(uint8_t* p, uint16_t value);
+void putU32(uint8_t* p, uint32_t value);
+uint16_t getU16(const uint8_t* p);
+uint32_t getU32(const uint8_t* p);
+bool scoreBetter(LeaderboardId id, int32_t a, int32_t b);
+bool loadScoreFile(const char* filename);
+void saveLeaderboards();
+
+// =============================================================================================================
+
+// Standard CRC-32 (as used by zip), bit by bit since the files are tiny
+uint32_t scoreCrc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void putU16(uint8_t* p, uint16_t value) {
+  p[0] = value;
+  p[1] = value >> 8;
+}
+
+void putU32(uint8_t* p, uint32_t value) {
+  putU16(p, value);
+  putU16(p + 2, value >> 16);
+}
+
+uint16_t getU16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+uint32_t getU32(const uint8_t* p) {
+  return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+// =============================================================================================================
+
+const LeaderboardInfo& leaderboardInfo(LeaderboardId id) {
+  return LEADERBOARDS[id];
+}
+
+bool leaderboardsReady() {
+  return leaderboardsLoaded;
+}
+
+const Leaderboard& getLeaderboard(LeaderboardId id) {
+  return leaderboards[id];
+}
+
+// True if score a ranks strictly above score b
+bool scoreBetter(LeaderboardId id, int32_t a, int32_t b) {
+  return LEADERBOARDS[id].order == HIGHEST_FIRST ? a > b : a < b;
+}
+
+bool scoreQualifies(LeaderboardId id, int32_t score) {
+  if (!leaderboardsLoaded) {
+    return false; // No card yet, saving now would overwrite the real tables
+  }
+  if (replayMode() != REPLAY_OFF) {
+    return false; // A name prompt would depend on the tables, which differ between recording and replay
+  }
+  if (LEADERBOARDS[id].order == HIGHEST_FIRST && score <= 0) {
+    return false; // A game that ended without scoring doesn't go on the board
+  }
+  const Leaderboard& board = getLeaderboard(id);
+  return board.count < LEADERBOARDS[id].size || scoreBetter(id, score, board.entries[board.count - 1].score);
+}
+
+void addScore(LeaderboardId id, const ScoreEntry& entry) {
+  if (!leaderboardsLoaded) {
+    return;
+  }
+  Leaderboard& board = leaderboards[id];
+  int size = LEADERBOARDS[id].size;
+
+  // Equal scores keep their older entry first
+  int i = 0;
+  while (i < board.count && !scoreBetter(id, entry.score, board.entries[i].score)) {
+    i++;
+  }
+  if (i >= size) {
+    return;
+  }
+
+  // Shift lower scores down, dropping the last one if the table is full
+  int last = board.count < size ? board.count : size - 1;
+  for (int j = last; j > i; j--) {
+    board.entries[j] = board.entries[j - 1];
+  }
+  board.entries[i] = entry;
+  board.entries[i].name[SCORE_NAME_SIZE - 1] = '\0';
+  if (board.count < size) {
+    board.count++;
+  }
+
+  saveLeaderboards();
+}
+
+// =============================================================================================================
+
+// Reads and validates the score file into a stack buffer, only touching the tables if it is intact
+bool loadScoreFile(const char* filename) {
+  File file = SD.open(filename, FILE_READ);
+  if (!file) {
+    return false;
+  }
+
+  uint8_t buffer[SCORE_FILE_MAX_SIZE];
+  size_t length = file.read(buffer, sizeof(buffer));
+  bool trailing = file.available() > 0;
+  file.close();
+
+  if (trailing || length < SCORE_HEADER_SIZE + 4 ||
+      getU32(buffer) != SCORE_FILE_MAGIC ||
+      getU16(buffer + 4) != SCORE_FILE_VERSION ||
+      getU32(buffer + length - 4) != scoreCrc32(buffer, length - 4)) {
+    Serial.print("Ignoring invalid score file ");
+    Serial.println(filename);
+    return false;
+  }
+
+  // Walk the sections once to check they fit before using any of them
+  int sections = getU16(buffer + 6);
+  size_t offset = SCORE_HEADER_SIZE;
+  for (int s = 0; s < sections; s++) {
+    if (offset + SCORE_SECTION_HEADER_SIZE > length - 4) {
+      return false;
+    }
+    offset += SCORE_SECTION_HEADER_SIZE + buffer[offset + 1] * SCORE_RECORD_SIZE;
+  }
+  if (offset != length - 4) {
+    return false;
+  }
+
+  // Sections of games no longer registered are skipped, entries beyond a shrunk table dropped
+  offset = SCORE_HEADER_SIZE;
+  for (int s = 0; s < sections; s++) {
+    int id = buffer[offset];
+    int count = buffer[offset + 1];
+    const uint8_t* record = buffer + offset + SCORE_SECTION_HEADER_SIZE;
+    offset += SCORE_SECTION_HEADER_SIZE + count * SCORE_RECORD_SIZE;
+    if (id >= LEADERBOARD_COUNT) {
+      continue;
+    }
+
+    Leaderboard& board = leaderboards[id];
+    board.count = min(count, LEADERBOARDS[id].size);
+    for (int i = 0; i < board.count; i++) {
+      memcpy(board.entries[i].name, record, SCORE_NAME_SIZE);
+      board.entries[i].name[SCORE_NAME_SIZE - 1] = '\0';
+      board.entries[i].score = (int32_t)getU32(record + SCORE_NAME_SIZE);
+      record += SCORE_RECORD_SIZE;
+    }
+  }
+  return true;
+}
+
+// Runs in the storage task after the card mounts, so boot never waits on the SD card.
+// Later remounts keep the tables already in memory, they are newer than the card.
+void loadLeaderboards() {
+  if (leaderboardsLoaded) {
+    return;
+  }
+
+  for (int id = 0; id < LEADERBOARD_COUNT; id++) {
+    leaderboards[id].count = 0;
+  }
+
+  // A complete temp file is newer than the score file it was about to replace
+  if (!loadScoreFile(SCORE_TEMP_FILE)) {
+    loadScoreFile(SCORE_FILE);
+  }
+  leaderboardsLoaded = true;
+}
+
+void saveLeaderboards() {
+  uint8_t buffer[SCORE_FILE_MAX_SIZE];
+  memset(buffer, 0, sizeof(buffer));
+
+  putU32(buffer, SCORE_FILE_MAGIC);
+  putU16(buffer + 4, SCORE_FILE_VERSION);
+  putU16(buffer + 6, LEADERBOARD_COUNT);
+  uint8_t* p = buffer + SCORE_HEADER_SIZE;
+  for (int id = 0; id < LEADERBOARD_COUNT; id++) {
+    const Leaderboard& board = leaderboards[id];
+    p[0] = id;
+    p[1] = board.count;
+    p += SCORE_SECTION_HEADER_SIZE;
+    for (int i = 0; i < board.count; i++) {
+      strncpy((char*)p, board.entries[i].name, SCORE_NAME_SIZE - 1);
+      putU32(p + SCORE_NAME_SIZE, (uint32_t)board.entries[i].score);
+      p += SCORE_RECORD_SIZE;
+    }
+  }
+  size_t length = p - buffer + 4;
+  putU32(p, scoreCrc32(buffer, length - 4));
+
+  // Written by the storage task, the caller carries on straight away
+  storageWriteFile(SCORE_FILE, buffer, length);
+}
+
+void recordGamePlayed(LeaderboardId id, int32_t score) {
+  if (replayMode() == REPLAY_PLAYING) {
+    return; // Already counted when it was recorded
+  }
+  char line[48];
+  snprintf(line, sizeof(line), "%s,%ld,%lu", LEADERBOARDS[id].title, (long)score, (unsigned long)(millis() / 1000));
+  storageAppendLine(STATS_FILE, line);
+}
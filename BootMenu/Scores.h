@@ -4,11 +4,96 @@
 #define SCORES_H
 
 #include <Arduino.h>
+#include <type_traits>
 
-// Define a structure for a score entry
+// Room for 3 initials and a terminator
+const int SCORE_NAME_SIZE = 4;
+
+// Largest table any game may register
+const int MAX_LEADERBOARD_SIZE = 5;
+
+// Define a structure for a score entry, plain data so tables copy without touching the heap
 struct ScoreEntry {
-  String name;
-  int score;
+  char name[SCORE_NAME_SIZE];
+  int32_t score;
+};
+static_assert(std::is_trivially_copyable<ScoreEntry>::value, "ScoreEntry must stay plain data");
+
+// Games that keep records. IDs are stored in the score file, so only append.
+enum LeaderboardId {
+  LEADERBOARD_TETRIS = 0,
+  LEADERBOARD_PONG,
+  LEADERBOARD_SNAKE,
+  LEADERBOARD_CHESS,
+  LEADERBOARD_COUNT
+};
+
+// Which end of the table is best
+enum ScoreOrder {
+  HIGHEST_FIRST,
+  LOWEST_FIRST
+};
+
+// Registry entry describing a game's table
+struct LeaderboardInfo {
+  const char* title; // Heading on the scoreboard
+  const char* unit;  // What the score counts, e.g. "pts"
+  ScoreOrder order;
+  int size;          // Entries kept, at most MAX_LEADERBOARD_SIZE
+};
+
+// A game's table, best entry first
+struct Leaderboard {
+  int count; // Entries in use
+  ScoreEntry entries[MAX_LEADERBOARD_SIZE];
 };
 
+/**
+ * @brief Returns the registry entry of a game's table.
+ */
+const LeaderboardInfo& leaderboardInfo(LeaderboardId id);
+
+/**
+ * @brief Reads every table from the score file. Passed to storageBegin() as the mount hook.
+ */
+void loadLeaderboards();
+
+/**
+ * @brief Checks whether the tables have been read. Until then they are empty and no score qualifies.
+ */
+bool leaderboardsReady();
+
+/**
+ * @brief Returns a game's table.
+ */
+const Leaderboard& getLeaderboard(LeaderboardId id);
+
+/**
+ * @brief Checks whether a score would earn a place in a game's table.
+ *
+ * Always false while loading, and while recording or replaying (see Replay.h). On tables
+ * where higher is better a score of 0 or less never qualifies, even with places free.
+ */
+bool scoreQualifies(LeaderboardId id, int32_t score);
+
+/**
+ * @brief Inserts an entry into a game's table and queues a save of all tables.
+ *
+ * The storage task writes the tables in one go to a temporary file which then
+ * replaces the score file, so a power cut never leaves the old scores half deleted.
+ */
+void addScore(LeaderboardId id, const ScoreEntry& entry);
+
+/**
+ * @brief Queues a line for the play statistics file (/stats.csv): game, score and uptime in seconds.
+ *
+ * Replays aren't counted.
+ */
+void recordGamePlayed(LeaderboardId id, int32_t score);
+
+/**
+ * @brief Asks the player for initials and records the score (defined in BootMenu.ino).
+ */
+void insertNewScore(LeaderboardId id, int32_t newScore);
+
 #endif // SCORES_H
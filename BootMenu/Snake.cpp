@@ -1,31 +1,24 @@
 // Snake.cpp
 
 #include "Snake.h"
+#include "SnakeBot.h"
+#include "Replay.h"
+#include "Frame.h"
 #include <esp_system.h>
 #include <Arduino.h>
 
-// Extern declarations for score arrays and functions
-extern ScoreEntry snakeScores[5];
-extern void insertNewScore(ScoreEntry scores[], int newScore);
-extern void writeScoresToSD(const char* filename, ScoreEntry scores[]);
-
-// Screen dimensions for portrait mode
-const int screenWidth = 170;   // Width of the TFT display in portrait
-const int screenHeight = 320;  // Height of the TFT display in portrait
-
-// Game grid dimensions
-const int gridSize = 10;  // Size of each grid square in pixels
-
-// Offset for score display
-const int yOffset = 20; // Pixels reserved at the top for the score
-
-const int gridWidth = screenWidth / gridSize;
-const int gridHeight = (screenHeight - yOffset) / gridSize; // Adjusted for score offset
-
 // Snake variables
-int snakeX[100];  // Snake's x positions
-int snakeY[100];  // Snake's y positions
+SnakeState* snake = NULL;
+int snakeHead;    // Ring index of the head
 int snakeLength;  // Length of the snake
+int snakeGrow;    // Segments still to be added at the tail
+int headX;        // Head position
+int headY;
+int erasedTail;   // Cell freed by the last move that is still on screen, -1 if none
+int drawnScore;   // Score currently shown at the top, -1 to force a redraw
+
+// Valid bits of the last occupancy word
+const uint32_t lastWordMask = (gridCells % 32) ? (1UL << (gridCells % 32)) - 1 : 0xFFFFFFFFUL;
 
 // Food position
 int foodX;
@@ -37,6 +30,7 @@ int dirY;
 
 // Game state
 bool gameOver;
+bool gameWon;   // The snake fills the whole grid
 
 // Score variable
 int snakeScore;
@@ -46,28 +40,37 @@ void readInputs();
 void moveSnake();
 void checkCollisions();
 void drawGame();
+void snakeRepaint();
 void showGameOver();
+void snakeDrawGameOver();
 void placeFood();
+void pushHead(int cell);
+void popTail();
+bool isOccupied(int cell);
 
 void snakeSetup() {
+  sceneState(snake);
   // Initialize the game variables
-  snakeLength = 3;
+  snakeLength = 0;
+  snakeHead = -1;
+  snakeGrow = 0;
+  frameSetPeriod(SNAKE_FRAME_MICROS);
+  memset(snake->occupied, 0, sizeof(snake->occupied));
 
   // Initialize the score
   snakeScore = 0;
 
   // Start the snake in the middle of the screen
-  snakeX[0] = gridWidth / 2;
-  snakeY[0] = gridHeight / 2;
+  headX = gridWidth / 2;
+  headY = gridHeight / 2;
 
   // Initialize the direction (moving upwards)
   dirX = 0;
   dirY = -1;
 
-  // Initialize the rest of the snake body behind the head
-  for (int i = 1; i < snakeLength; i++) {
-    snakeX[i] = snakeX[0];
-    snakeY[i] = snakeY[0] + i;
+  // Lay out the body below the head, tail first
+  for (int i = 2; i >= 0; i--) {
+    pushHead((headY + i) * gridWidth + headX);
   }
 
   // Place the food at a random position
@@ -76,14 +79,29 @@ void snakeSetup() {
   // Set the screen rotation to portrait mode
   tft.setRotation(4);  // Adjust this value based on your display's orientation
 
-  // Clear the screen
-  tft.fillScreen(TFT_BLACK);
+  // Draw the whole snake once, drawGame() only draws what moved
+  snakeRepaint();
 
   gameOver = false;
+  gameWon = false;
 }
 
+// Runs one game tick, or one poll of the game over screen
 void snakeLoop() {
-  while (!gameOver) {
+  // Let the autoplayer press its buttons before they are read
+  if (snakeBotActive) {
+    snakeBotUpdate();
+  }
+
+  if (sceneRepaintRequested()) {
+    if (gameOver) {
+      snakeDrawGameOver();
+    } else {
+      snakeRepaint();
+    }
+  }
+
+  if (!gameOver) {
     // Check if 'B' button is pressed to exit
     if (bButton == 0) {
       esp_restart();  // Restart the microcontroller
@@ -95,22 +113,17 @@ void snakeLoop() {
     checkCollisions();
     drawGame();
 
-    // Delay to control game speed
-    delay(100);  // Adjust speed as necessary
-  }
-
-  if (gameOver) {
-    showGameOver();
-    while (true) {
-      // Wait for 'A' button to restart or 'B' button to exit to menu
-      if (aButton == 0) {
-        snakeSetup();
-        return;
-      } else if (bButton == 0) {
-        esp_restart();  // Restart the microcontroller
-      }
-      delay(100);
+    if (gameOver) {
+      showGameOver();
     }
+    return;
+  }
+
+  // Wait for 'A' button to restart or 'B' button to exit to menu
+  if (aButton == 0) {
+    snakeSetup();
+  } else if (bButton == 0) {
+    esp_restart();  // Restart the microcontroller
   }
 }
 
@@ -132,38 +145,37 @@ void readInputs() {
 }
 
 void moveSnake() {
-  // Move the body
-  for (int i = snakeLength - 1; i > 0; i--) {
-    snakeX[i] = snakeX[i - 1];
-    snakeY[i] = snakeY[i - 1];
+  // Free the tail first, the head may move into the cell it leaves this tick
+  if (snakeGrow > 0) {
+    snakeGrow--;
+  } else {
+    popTail();
   }
 
   // Move the head
-  snakeX[0] += dirX;
-  snakeY[0] += dirY;
+  headX += dirX;
+  headY += dirY;
 }
 
 void checkCollisions() {
   // Check collision with walls
-  if (snakeX[0] < 0 || snakeX[0] >= gridWidth || snakeY[0] < 0 || snakeY[0] >= gridHeight) {
+  if (headX < 0 || headX >= gridWidth || headY < 0 || headY >= gridHeight) {
     gameOver = true;
     return;
   }
 
   // Check collision with self
-  for (int i = 1; i < snakeLength; i++) {
-    if (snakeX[0] == snakeX[i] && snakeY[0] == snakeY[i]) {
-      gameOver = true;
-      return;
-    }
+  int cell = headY * gridWidth + headX;
+  if (isOccupied(cell)) {
+    gameOver = true;
+    return;
   }
+  pushHead(cell);
 
   // Check if snake eats the food
-  if (snakeX[0] == foodX && snakeY[0] == foodY) {
-    snakeLength++;
-    // Add new segment at the end
-    snakeX[snakeLength - 1] = snakeX[snakeLength - 2];
-    snakeY[snakeLength - 1] = snakeY[snakeLength - 2];
+  if (headX == foodX && headY == foodY) {
+    // Add new segment at the end on the next move
+    snakeGrow++;
 
     // Increment score
     snakeScore++;
@@ -172,21 +184,44 @@ void checkCollisions() {
   }
 }
 
-void drawGame() {
-  // Clear screen
-  tft.fillScreen(TFT_BLACK);
+void pushHead(int cell) {
+  snakeHead = (snakeHead + 1) % gridCells;
+  snake->body[snakeHead] = cell;
+  snake->occupied[cell >> 5] |= 1UL << (cell & 31);
+  snakeLength++;
+}
 
-  // Draw the score at the top center
-  tft.setTextColor(TFT_WHITE);
-  tft.setTextSize(2);
-  tft.drawCentreString("Score: " + String(snakeScore), screenWidth / 2, 5, 1);
+void popTail() {
+  int cell = snake->body[(snakeHead - snakeLength + 1 + gridCells) % gridCells];
+  snake->occupied[cell >> 5] &= ~(1UL << (cell & 31));
+  snakeLength--;
+  erasedTail = cell;
+}
 
-  // Draw snake
-  for (int i = 0; i < snakeLength; i++) {
-    int x = snakeX[i] * gridSize;
-    int y = snakeY[i] * gridSize + yOffset; // Apply yOffset for score space
-    tft.fillRect(x, y, gridSize, gridSize, TFT_GREEN);
+bool isOccupied(int cell) {
+  return (snake->occupied[cell >> 5] >> (cell & 31)) & 1;
+}
+
+void drawGame() {
+  if (gameOver) return;
+
+  // Draw the score at the top center when it changes
+  if (drawnScore != snakeScore) {
+    tft.fillRect(0, 0, screenWidth, yOffset, TFT_BLACK);
+    tft.setTextColor(TFT_WHITE);
+    tft.setTextSize(2);
+    tft.drawCentreString("Score: " + String(snakeScore), screenWidth / 2, 5, 1);
+    drawnScore = snakeScore;
+  }
+
+  // Erase the cell the tail left, unless the head moved into it
+  if (erasedTail >= 0 && !isOccupied(erasedTail)) {
+    tft.fillRect((erasedTail % gridWidth) * gridSize, (erasedTail / gridWidth) * gridSize + yOffset, gridSize, gridSize, TFT_BLACK);
   }
+  erasedTail = -1;
+
+  // Draw the new head
+  tft.fillRect(headX * gridSize, headY * gridSize + yOffset, gridSize, gridSize, TFT_GREEN); // Apply yOffset for score space
 
   // Draw food
   int foodPosX = foodX * gridSize;
@@ -194,15 +229,31 @@ void drawGame() {
   tft.fillRect(foodPosX, foodPosY, gridSize, gridSize, TFT_RED);
 }
 
+// Clears the screen and draws the whole snake, the next drawGame() adds the score and food
+void snakeRepaint() {
+  tft.fillScreen(TFT_BLACK);
+  for (int i = 0; i < snakeLength; i++) {
+    int cell = snake->body[(snakeHead - i + gridCells) % gridCells];
+    tft.fillRect((cell % gridWidth) * gridSize, (cell / gridWidth) * gridSize + yOffset, gridSize, gridSize, TFT_GREEN);
+  }
+  erasedTail = -1;
+  drawnScore = -1;
+}
+
 void showGameOver() {
-  // Update high scores if current score qualifies
-  if (snakeScore > snakeScores[4].score) {
-    // Insert the new score into the list
-    insertNewScore(snakeScores, snakeScore);
-    // Write updated scores to SD card
-    writeScoresToSD("/snake_scores.txt", snakeScores);
+  // Update high scores if current score qualifies (demo games don't count)
+  if (!snakeBotActive) {
+    recordGamePlayed(LEADERBOARD_SNAKE, snakeScore);
+    if (scoreQualifies(LEADERBOARD_SNAKE, snakeScore)) {
+      // Insert the new score into the list and save it
+      insertNewScore(LEADERBOARD_SNAKE, snakeScore);
+    }
   }
 
+  snakeDrawGameOver();
+}
+
+void snakeDrawGameOver() {
   // Clear the screen with black color
   tft.fillScreen(TFT_BLACK);
 
@@ -213,7 +264,7 @@ void showGameOver() {
   tft.setTextSize(2);
 
   // Draw "Game Over" at the center, slightly above the middle
-  tft.drawCentreString("Game Over", screenWidth / 2, screenHeight / 2 - 50, 1);
+  tft.drawCentreString(gameWon ? "You Win!" : "Game Over", screenWidth / 2, screenHeight / 2 - 50, 1);
 
   // Display the final score
   tft.setTextSize(2);
@@ -229,7 +280,31 @@ void showGameOver() {
   tft.drawCentreString("Press B for Menu", screenWidth / 2, screenHeight / 2 + 30, 1);
 }
 
+// Pick a cell uniformly among the free ones by rank-select over the occupancy bitmap,
+// one popcount per 32 cells however long the snake is
 void placeFood() {
-  foodX = random(0, gridWidth);
-  foodY = random(0, gridHeight);
+  int freeCells = gridCells - snakeLength;
+  if (freeCells == 0) {
+    gameWon = true;
+    gameOver = true;
+    return;
+  }
+
+  int rank = replayRandom(0, freeCells);
+  for (int w = 0; w < occupiedWords; w++) {
+    uint32_t freeBits = ~snake->occupied[w];
+    if (w == occupiedWords - 1) freeBits &= lastWordMask;
+    int count = __builtin_popcount(freeBits);
+    if (rank >= count) {
+      rank -= count;
+      continue;
+    }
+
+    // Drop the lowest free bits until the wanted one is the lowest
+    while (rank-- > 0) freeBits &= freeBits - 1;
+    int cell = w * 32 + __builtin_ctz(freeBits);
+    foodX = cell % gridWidth;
+    foodY = cell / gridWidth;
+    return;
+  }
 }
@@ -3,11 +3,12 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
-#include <TFT_eSPI.h>
+#include "Render.h"
 #include "Scores.h" // Include Scores.h
+#include "Scene.h"
 
 // Externally declare the TFT display object
-extern TFT_eSPI tft;
+extern ArcadeDisplay tft;
 
 // Externally declare the button pins
 extern int leftButton;
@@ -22,6 +23,42 @@ extern void insertNewScore(ScoreEntry scores[], int newScore);
 extern void writeScoresToSD(const char* filename, ScoreEntry scores[]);
 extern ScoreEntry snakeScores[5];
 
+// Screen dimensions for portrait mode
+const int screenWidth = 170;   // Width of the TFT display in portrait
+const int screenHeight = 320;  // Height of the TFT display in portrait
+
+// Game grid dimensions
+const int gridSize = 10;  // Size of each grid square in pixels
+
+// Offset for score display
+const int yOffset = 20; // Pixels reserved at the top for the score
+
+const int gridWidth = screenWidth / gridSize;
+const int gridHeight = (screenHeight - yOffset) / gridSize; // Adjusted for score offset
+
+// One move per frame
+const unsigned long SNAKE_FRAME_MICROS = 100000;
+
+const int gridCells = gridWidth * gridHeight; // 17 x 30 = 510 cells
+const int occupiedWords = (gridCells + 31) / 32;
+
+// Body and occupancy, in the scene arena (Scene.h) while Snake runs
+struct SnakeState {
+  uint16_t body[gridCells];           // Ring buffer of cell indices (y * gridWidth + x), tail to head
+  uint32_t occupied[occupiedWords];   // One bit per grid cell, set where the snake's body is
+};
+
+// Game state shared with the autoplayer (SnakeBot.cpp)
+extern SnakeState* snake;
+extern int snakeHead;
+extern int snakeLength;
+extern int snakeGrow;
+extern int headX;
+extern int headY;
+extern int foodX;
+extern int foodY;
+extern bool gameOver;
+
 // Function prototypes
 void snakeSetup();
 void snakeLoop();
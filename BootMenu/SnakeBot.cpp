@@ -0,0 +1,135 @@
+// SnakeBot.cpp
+
+#include "SnakeBot.h"
+#include "Snake.h"
+#include "ControllerInput.h"
+
+// The cycle below runs in rows across columns 1.. and returns up column 0
+static_assert(gridHeight % 2 == 0, "Hamiltonian cycle needs an even number of rows");
+
+// Cells a shortcut must leave between the new head and the tail on the cycle
+const int SHORTCUT_MARGIN = 4;
+
+bool snakeBotActive = false;
+
+// Tables, in the scene arena (Scene.h) while the bot plays, so a tick never touches the heap
+// or a deep stack
+struct SnakeBotState {
+  // Hamiltonian cycle over the grid: successor and position of every cell
+  uint16_t cycleNext[gridCells];
+  uint16_t cycleIndex[gridCells];
+
+  // Search buffers
+  uint16_t bfsQueue[gridCells];
+  int16_t bfsParent[gridCells];
+  uint32_t bfsBlocked[occupiedWords];
+};
+
+SnakeBotState* snakeBot = NULL;
+
+// Function prototypes (private to this file)
+void buildCycle();
+int cycleDistance(int from, int to);
+bool findPath(int from, int to);
+int firstStep(int from, int to);
+
+void snakeBotStart() {
+  sceneState(snakeBot);
+  buildCycle();
+  snakeBotActive = true;
+  applyButtonMask(1, BUTTONS_RELEASED);
+}
+
+void snakeBotUpdate() {
+  if (gameOver) {
+    applyButtonMask(1, BUTTON_PRESSED(BUTTON_A));   // Play again
+    return;
+  }
+
+  int head = headY * gridWidth + headX;
+  int tail = snake->body[(snakeHead - snakeLength + 1 + gridCells) % gridCells];
+  int food = foodY * gridWidth + foodX;
+
+  // Following the cycle is always safe: the body lies behind the head in cycle order
+  int next = snakeBot->cycleNext[head];
+
+  // Take the shortest path to the food instead when its first step stays between the
+  // head and the food on the cycle and keeps clear of the tail, so the tail remains
+  // reachable along the cycle afterwards
+  memcpy(snakeBot->bfsBlocked, snake->occupied, sizeof(snakeBot->bfsBlocked));
+  if (snakeGrow == 0) {
+    snakeBot->bfsBlocked[tail >> 5] &= ~(1UL << (tail & 31));   // Frees up on this move
+  }
+  if (findPath(head, food)) {
+    int step = firstStep(head, food);
+    int skip = cycleDistance(head, step);
+    if (skip <= cycleDistance(head, food) && skip < cycleDistance(head, tail) - snakeGrow - SHORTCUT_MARGIN) {
+      next = step;
+    }
+  }
+
+  int moveX = next % gridWidth - headX;
+  int moveY = next / gridWidth - headY;
+  int button = moveY < 0 ? BUTTON_UP : moveY > 0 ? BUTTON_DOWN : moveX < 0 ? BUTTON_LEFT : BUTTON_RIGHT;
+  applyButtonMask(1, BUTTON_PRESSED(button));
+}
+
+// Serpentine over columns 1.. row by row, then straight back up column 0
+void buildCycle() {
+  int previous = 0;   // (0, 0) closes the cycle into (1, 0)
+  int index = 0;
+  for (int y = 0; y < gridHeight; y++) {
+    for (int i = 1; i < gridWidth; i++) {
+      int cell = y * gridWidth + ((y % 2 == 0) ? i : gridWidth - i);
+      snakeBot->cycleNext[previous] = cell;
+      snakeBot->cycleIndex[cell] = index++;
+      previous = cell;
+    }
+  }
+  for (int y = gridHeight - 1; y >= 0; y--) {
+    snakeBot->cycleNext[previous] = y * gridWidth;
+    snakeBot->cycleIndex[y * gridWidth] = index++;
+    previous = y * gridWidth;
+  }
+}
+
+// Steps from 'from' to 'to' going forward along the cycle
+int cycleDistance(int from, int to) {
+  return (snakeBot->cycleIndex[to] - snakeBot->cycleIndex[from] + gridCells) % gridCells;
+}
+
+// Breadth-first search from 'from' to 'to' around the cells set in bfsBlocked
+bool findPath(int from, int to) {
+  for (int i = 0; i < gridCells; i++) snakeBot->bfsParent[i] = -1;
+  int head = 0, tail = 0;
+  snakeBot->bfsQueue[tail++] = from;
+  snakeBot->bfsParent[from] = from;
+
+  while (head < tail) {
+    int cell = snakeBot->bfsQueue[head++];
+    if (cell == to) return true;
+    int x = cell % gridWidth;
+    int y = cell / gridWidth;
+    int neighbours[4] = {
+      y > 0 ? cell - gridWidth : -1,
+      y < gridHeight - 1 ? cell + gridWidth : -1,
+      x > 0 ? cell - 1 : -1,
+      x < gridWidth - 1 ? cell + 1 : -1
+    };
+    for (int i = 0; i < 4; i++) {
+      int n = neighbours[i];
+      if (n < 0 || snakeBot->bfsParent[n] >= 0) continue;
+      if ((snakeBot->bfsBlocked[n >> 5] >> (n & 31)) & 1) continue;
+      snakeBot->bfsParent[n] = cell;
+      snakeBot->bfsQueue[tail++] = n;
+    }
+  }
+  return false;
+}
+
+// First cell of the path found by findPath()
+int firstStep(int from, int to) {
+  int cell = to;
+  while (snakeBot->bfsParent[cell] != from) cell = snakeBot->bfsParent[cell];
+  return cell;
+}
@@ -0,0 +1,25 @@
+// SnakeBot.h
+
+#ifndef SNAKE_BOT_H
+#define SNAKE_BOT_H
+
+#include <Arduino.h>
+
+// True while the autoplayer owns controller 1 (attract mode, benchmarks)
+extern bool snakeBotActive;
+
+/**
+ * @brief Hands controller 1 to the autoplayer. Call after snakeSetup().
+ */
+void snakeBotStart();
+
+/**
+ * @brief Chooses the next move and applies it to controller 1 as a button packet.
+ *
+ * Follows a fixed Hamiltonian cycle over the grid, cutting across on the shortest path to
+ * the food whenever that keeps the tail reachable along the cycle. It never dies and
+ * eventually fills the board. Called by snakeLoop() before readInputs() while active.
+ */
+void snakeBotUpdate();
+
+#endif // SNAKE_BOT_H
@@ -0,0 +1,262 @@
+// Storage.cpp
+
+#include "Storage.h"
+#include <SD.h>
+
+// Request kinds handled by the storage task
+enum StorageCommand {
+  STORAGE_WRITE_FILE,
+  STORAGE_APPEND_LINE,
+  STORAGE_CALL
+};
+
+struct StorageRequest {
+  StorageCommand command;
+  const char* path;
+  void (*function)();  // STORAGE_CALL only
+  uint32_t ticket;
+  uint16_t length;
+  uint8_t data[STORAGE_MAX_DATA];
+};
+
+#ifndef ARCADE_HOST
+QueueHandle_t storageQueue = NULL;
+#endif
+bool storageStarted = false;
+void (*storageMountHook)() = NULL;
+volatile bool storageMounted = false;
+
+uint32_t storageNextTicket = 1;           // Only touched by the game task
+volatile uint32_t storageDoneTicket = 0;  // Highest ticket carried out
+volatile bool storageFailed = false;
+
+// Requests drained from the queue in one go, after coalescing
+StorageRequest storageBatch[STORAGE_QUEUE_LENGTH + 1];
+
+// Function prototypes (private to this file)
+uint32_t storageSubmit(StorageRequest& request);
+int storageCoalesce(int count, const StorageRequest& request);
+bool storageRun(const StorageRequest* batch, int count, int index, bool* handled);
+void storageMount();
+void storageExecute(int count, uint32_t lastTicket);
+void storageTask(void* parameter);
+
+// =============================================================================================================
+
+void storageBegin(void (*onMount)()) {
+  if (storageStarted) return;
+  storageStarted = true;
+  storageMountHook = onMount;
+#ifdef ARCADE_HOST
+  // No threads on the host, requests are carried out as they are made so runs repeat exactly
+  storageMount();
+#else
+  storageQueue = xQueueCreate(STORAGE_QUEUE_LENGTH, sizeof(StorageRequest));
+  // Core 0 with the Wi-Fi stack, the games run in loop() on core 1
+  xTaskCreatePinnedToCore(storageTask, "storage", 4096, NULL, 1, NULL, 0);
+#endif
+}
+
+bool storageReady() {
+  return storageMounted;
+}
+
+// Hands a request to the task. Blocks only if the queue is full, which needs several saves
+// queued behind a very slow card.
+uint32_t storageSubmit(StorageRequest& request) {
+  if (!storageStarted) {
+    Serial.println("Storage not started");
+    return 0;
+  }
+  request.ticket = storageNextTicket++;
+#ifdef ARCADE_HOST
+  storageBatch[0] = request;
+  storageExecute(1, request.ticket);
+#else
+  xQueueSend(storageQueue, &request, portMAX_DELAY);
+#endif
+  return request.ticket;
+}
+
+uint32_t storageWriteFile(const char* path, const uint8_t* data, size_t length) {
+  static StorageRequest request; // Too big for the caller's stack, only the game task submits
+  if (length > STORAGE_MAX_DATA) {
+    Serial.println("Storage request too large");
+    return 0;
+  }
+  request.command = STORAGE_WRITE_FILE;
+  request.path = path;
+  request.length = length;
+  memcpy(request.data, data, length);
+  return storageSubmit(request);
+}
+
+uint32_t storageAppendLine(const char* path, const char* line) {
+  static StorageRequest request;
+  size_t length = strlen(line);
+  if (length + 1 > STORAGE_MAX_DATA) {
+    Serial.println("Storage request too large");
+    return 0;
+  }
+  request.command = STORAGE_APPEND_LINE;
+  request.path = path;
+  request.length = length;
+  memcpy(request.data, line, length);
+  return storageSubmit(request);
+}
+
+uint32_t storageCall(void (*function)()) {
+  static StorageRequest request;
+  request.command = STORAGE_CALL;
+  request.path = "";
+  request.function = function;
+  request.length = 0;
+  return storageSubmit(request);
+}
+
+bool storageComplete(uint32_t ticket) {
+  return (int32_t)(storageDoneTicket - ticket) >= 0;
+}
+
+bool storageTakeResult() {
+  bool ok = !storageFailed;
+  storageFailed = false;
+  return ok;
+}
+
+// =============================================================================================================
+
+bool writeFileReplacing(const char* path, const uint8_t* data, size_t length) {
+  char temp[64];
+  snprintf(temp, sizeof(temp), "%s.tmp", path);
+
+  File file = SD.open(temp, FILE_WRITE);
+  if (!file) {
+    Serial.println("Failed to open file for writing");
+    return false;
+  }
+  size_t written = file.write(data, length);
+  file.close();
+  if (written != length) {
+    Serial.println("Failed to write file");
+    SD.remove(temp);
+    return false;
+  }
+
+  // Until the rename below, readers pick the finished temp file up instead
+  SD.remove(path);
+  if (!SD.rename(temp, path)) {
+    Serial.println("Failed to replace file");
+    return false;
+  }
+  return true;
+}
+
+// Adds a drained request to the batch, replacing an older save of the same file
+int storageCoalesce(int count, const StorageRequest& request) {
+  if (request.command == STORAGE_WRITE_FILE) {
+    for (int i = 0; i < count; i++) {
+      if (storageBatch[i].command == STORAGE_WRITE_FILE && strcmp(storageBatch[i].path, request.path) == 0) {
+        storageBatch[i] = request;
+        return count;
+      }
+    }
+  }
+  storageBatch[count] = request;
+  return count + 1;
+}
+
+// Carries out one batch entry. Appends also take every later line for the same file.
+bool storageRun(const StorageRequest* batch, int count, int index, bool* handled) {
+  const StorageRequest& request = batch[index];
+  handled[index] = true;
+  if (request.command == STORAGE_WRITE_FILE) {
+    return writeFileReplacing(request.path, request.data, request.length);
+  }
+  if (request.command == STORAGE_CALL) {
+    request.function();
+    return true;
+  }
+
+  File file = SD.open(request.path, FILE_APPEND);
+  if (!file) {
+    Serial.println("Failed to open file for appending");
+    return false;
+  }
+  bool ok = true;
+  for (int i = index; i < count; i++) {
+    if (batch[i].command == STORAGE_APPEND_LINE && strcmp(batch[i].path, request.path) == 0) {
+      handled[i] = true;
+      ok &= file.write(batch[i].data, batch[i].length) == batch[i].length;
+      ok &= file.write('\n') == 1;
+    }
+  }
+  file.close();
+  return ok;
+}
+
+// Tries to bring the card up, then lets the owner read whatever it needs
+void storageMount() {
+  unsigned long start = micros();
+  if (!SD.begin(SD_CS_PIN)) {
+    SD.end();
+    return;
+  }
+  unsigned long mounted = micros();
+  if (storageMountHook != NULL) {
+    storageMountHook();
+  }
+  storageMounted = true;
+  // Outside the boot profile, which only the game task records into
+  Serial.printf("SD Card initialized: mount %lu us, mount hook %lu us\n", mounted - start, micros() - mounted);
+}
+
+// Carries out the first count requests of storageBatch, then reports them done
+void storageExecute(int count, uint32_t lastTicket) {
+  if (!storageMounted) {
+    storageMount();
+  }
+  bool handled[STORAGE_QUEUE_LENGTH + 1] = {false};
+  bool ok = storageMounted;
+  for (int i = 0; i < count && storageMounted; i++) {
+    if (!handled[i]) {
+      ok &= storageRun(storageBatch, count, i, handled);
+    }
+  }
+
+  if (!ok) {
+    // Most likely the card was pulled, start over with a fresh mount
+    storageFailed = true;
+    storageMounted = false;
+    SD.end();
+  }
+  storageDoneTicket = lastTicket;
+}
+
+#ifndef ARCADE_HOST
+// Owns the SD card: mounts it, waits for requests, drains whatever else has queued up
+// meanwhile, and writes each file once. Without a card, requests fail straight away so
+// callers never wait on the queue.
+void storageTask(void* parameter) {
+  StorageRequest request;
+  storageMount();
+  if (!storageMounted) {
+    Serial.println("Card Mount Failed, retrying in the background");
+  }
+
+  while (true) {
+    if (xQueueReceive(storageQueue, &request, storageMounted ? portMAX_DELAY : pdMS_TO_TICKS(STORAGE_RETRY_MS)) != pdTRUE) {
+      storageMount(); // Timed out without a card, see if one was inserted
+      continue;
+    }
+    int count = storageCoalesce(0, request);
+    uint32_t lastTicket = request.ticket;
+    while (count < STORAGE_QUEUE_LENGTH + 1 && xQueueReceive(storageQueue, &request, 0) == pdTRUE) {
+      count = storageCoalesce(count, request);
+      lastTicket = request.ticket;
+    }
+
+    storageExecute(count, lastTicket);
+  }
+}
+#endif
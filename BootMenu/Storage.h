@@ -0,0 +1,85 @@
+// Storage.h
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+
+// Chip select of the SD card reader, the board's default SPI SS unless wired elsewhere
+#define SD_CS_PIN SS
+
+// How often the task retries mounting while no card is found
+const int STORAGE_RETRY_MS = 2000;
+
+// Largest file image or line a single request can carry
+const int STORAGE_MAX_DATA = 256;
+
+// Requests that can wait in the queue before callers block
+const int STORAGE_QUEUE_LENGTH = 4;
+
+/**
+ * @brief Starts the background task that owns the SD card. Returns at once.
+ *
+ * The task mounts the card itself, retrying every STORAGE_RETRY_MS until one is inserted,
+ * and remounts after a failed request (card pulled and put back).
+ * @param onMount Called from the task after every successful mount, before any queued
+ *                request is carried out. May be NULL.
+ */
+void storageBegin(void (*onMount)());
+
+/**
+ * @brief Checks whether a card is mounted.
+ */
+bool storageReady();
+
+/**
+ * @brief Queues a whole-file save and returns at once.
+ *
+ * The task writes the image to "<path>.tmp" and renames it over path. If several
+ * saves of the same file are waiting, only the newest is written.
+ * @param path Path of the file. Must stay valid until the save completes (use a literal).
+ * @param data File contents, copied into the request.
+ * @param length Number of bytes, at most STORAGE_MAX_DATA.
+ * @return Ticket to pass to storageComplete(), 0 if the request was rejected.
+ */
+uint32_t storageWriteFile(const char* path, const uint8_t* data, size_t length);
+
+/**
+ * @brief Queues a line to be appended to a text file and returns at once.
+ *
+ * Waiting lines for the same file are appended with a single open and close.
+ * @param path Path of the file. Must stay valid until the append completes (use a literal).
+ * @param line Text without a newline, copied into the request.
+ * @return Ticket to pass to storageComplete(), 0 if the request was rejected.
+ */
+uint32_t storageAppendLine(const char* path, const char* line);
+
+/**
+ * @brief Queues a function to run on the storage task and returns at once.
+ *
+ * For reading files after boot, everything that touches the card has to run on the task.
+ * Skipped if no card is mounted, so the function should leave a flag saying it ran.
+ * @return Ticket to pass to storageComplete(), 0 if the request was rejected.
+ */
+uint32_t storageCall(void (*function)());
+
+/**
+ * @brief Checks whether a request, and every request queued before it, has been carried out.
+ */
+bool storageComplete(uint32_t ticket);
+
+/**
+ * @brief Returns false if any request carried out since the last call failed.
+ */
+bool storageTakeResult();
+
+/**
+ * @brief Writes a whole file by way of "<path>.tmp" so a power cut leaves either the old or the new contents.
+ *
+ * Only for the storage task and its onMount hook. FAT can't rename over an existing file, so readers should prefer a
+ * valid "<path>.tmp" left by an interrupted save.
+ * @return true if the file was written and renamed into place.
+ */
+bool writeFileReplacing(const char* path, const uint8_t* data, size_t length);
+
+#endif // STORAGE_H
@@ -4,11 +4,12 @@
 #define TETRIS_H
 
 #include <SPI.h>
-#include <TFT_eSPI.h>
+#include "Render.h"
 #include "Scores.h" // Include Scores.h
+#include "Scene.h"
 
 // Externally declare the TFT display object
-extern TFT_eSPI tft;
+extern ArcadeDisplay tft;
 
 // Externally declare the button pins
 extern int leftButton;
@@ -34,6 +35,26 @@ struct Block {
     int color;
 };
 
+// Field dimensions
+const int Length = 11;     // the number of pixels for a side of a block
+const int Width  = 10;     // the number of horizontal blocks
+const int Height = 20;     // the number of vertical blocks
+
+// Field and block images, in the scene arena (Scene.h) while Tetris runs
+struct TetrisState {
+  uint16_t BlockImage[16][Length][Length];  // Block (0-7 solid, 8-15 ghost), row-major
+  int screen[Width][Height];                // it shows color-numbers of all positions
+  uint8_t drawn[Width][Height];             // BlockImage index currently on the TFT for each cell, 0xFF = unknown
+};
+
+// Game state shared with the autoplayer (TetrisBot.cpp)
+extern TetrisState* tetris;
+extern Point pos;
+extern Block block;
+extern int rot;
+extern bool started, gameover;
+extern unsigned long spawn_cnt;
+
 // Function prototypes
 void tetrisSetup();
 void tetrisLoop();
@@ -45,8 +66,12 @@ bool GetSquares(Block block, Point pos, int rot, Point* squares);
 void DeleteLine();
 void PutStartPos();
 void Draw();
+void tetrisRepaint();
+void DrawCell(int i, int j, int image);
+void UpdateGhost();
 void KeyPadLoop();
 void GameOver();
 void make_block(int n, uint16_t color);
+void make_ghost(int n, uint16_t color);
 
 #endif // TETRIS_H
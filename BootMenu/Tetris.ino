@@ -1,25 +1,21 @@
 // tetris.ino
 
 #include "Tetris.h"
+#include "TetrisBot.h"
+#include "Replay.h"
+#include "Frame.h"
 #include <SPI.h>
 #include <Arduino.h>
 
-// Extern declarations for score arrays and functions
-extern ScoreEntry tetrisScores[5];
-extern void insertNewScore(ScoreEntry scores[], int newScore);
-extern void writeScoresToSD(const char* filename, ScoreEntry scores[]);
-
 // Add the definition for GetNextPosRot
 void GetNextPosRot(Point* pnext_pos, int* pnext_rot);
 
-uint16_t BlockImage[8][12][12];                            // Block
-uint16_t backBuffer[220][110];                             // GAME AREA
-const int Length = 11;     // the number of pixels for a side of a block
-const int Width  = 10;     // the number of horizontal blocks
-const int Height = 20;     // the number of vertical blocks
-int screen[Width][Height] = {0}; // it shows color-numbers of all positions
+const int GHOST = 8;       // BlockImage offset of the outlined ghost variant of each color
+TetrisState* tetris = NULL;
 Point pos; Block block;
+Point ghost_pos;           // where the falling block would land with a hard drop
 int rot, fall_cnt = 0;
+unsigned long spawn_cnt = 0; // number of blocks spawned, lets the autoplayer spot a new block
 bool started = false, gameover = false;
 boolean but_A = false, but_LEFT = false, but_RIGHT = false;
 boolean but_DOWN = false, but_UP = false;
@@ -52,6 +48,16 @@ int score=0;
 int lvl=1;
 
 void tetrisSetup(void) {
+  sceneState(tetris);
+  // Start from an empty field, the attract mode sets up several games per boot
+  for (int j = 0; j < Height; ++j)
+    for (int i = 0; i < Width; ++i)
+      tetris->screen[i][j] = 0;
+  score = 0;
+  lvl = 1;
+  started = false;
+  gameover = false;
+
   tft.init();
   tft.setRotation(4); // Adjust as needed
   tft.setTextSize(1); // Adjust text size
@@ -77,26 +83,44 @@ void tetrisSetup(void) {
   make_block( 5, 0x87FF);       // __D,DDD  YELLOW
   make_block( 6, 0xF00F);       // _DD,DD_  LIGHT GREEN
   make_block( 7, 0xF8FC);       // _D_,DDD  PINK
+  for (int n = 1; n < 8; ++n) make_ghost(n, tetris->BlockImage[n][Length / 2][Length / 2]);
   //----------------------------------------------------------------------
   PutStartPos();                             // Start Position
-  for (int i = 0; i < 4; ++i) screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
+  UpdateGhost();
+  for (int i = 0; i < 4; ++i) tetris->screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
+  memset(tetris->drawn, 0xFF, sizeof(tetris->drawn)); // Nothing of the field is on screen yet
   Draw();                                    // Draw block
 }
 
+// Draws the whole screen again: the frame, the score and every cell of the field
+void tetrisRepaint() {
+  tft.fillScreen(TFT_BLACK);
+  tft.drawLine(11,19,122,19,GREY);
+  tft.drawLine(11,19,11,240,GREY);
+  tft.drawLine(122,19,122,240,GREY);
+  tft.drawString("SCORE:"+String(score),14,8,1);
+  tft.drawString("LVL:"+String(lvl),88,8,1);
+  memset(tetris->drawn, 0xFF, sizeof(tetris->drawn));
+  Draw();
+}
+
 //========================================================================
 
 void tetrisLoop() {
+  frameSetPeriod(game_speed * 1000UL); // SPEED ADJUST, one step per frame
+  if (sceneRepaintRequested()) tetrisRepaint();
   if (gameover) {
     if(leftButton == 0|| rightButton == 0 || downButton == 0) {
       for (int j = 0; j < Height; ++j)
       for (int i = 0; i < Width; ++i)
-        screen[i][j] = 0;
+        tetris->screen[i][j] = 0;
       gameover = false;
       score = 0;
       game_speed = 20;
       lvl = 1;
       PutStartPos();                             // Start Position
-      for (int i = 0; i < 4; ++i) screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
+      UpdateGhost();
+      for (int i = 0; i < 4; ++i) tetris->screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
       tft.drawString("SCORE:"+String(score),14,8,1);
       tft.drawString("LVL:"+String(lvl),88,8,1);
       Draw();
@@ -109,7 +133,6 @@ void tetrisLoop() {
     int next_rot = rot;
     GetNextPosRot(&next_pos, &next_rot);
     ReviseScreen(next_pos, next_rot);
-    delay(game_speed);    // SPEED ADJUST
   }
 }
 
@@ -141,33 +164,43 @@ void GetNextPosRot(Point* pnext_pos, int* pnext_rot) {
   }
   else if (but_UP) {
     but_UP = false;
-    // Instant drop
-    while (true) {
-      Point temp_pos = *pnext_pos;
-      temp_pos.Y += 1;
-      Point temp_squares[4];
-      if (GetSquares(block, temp_pos, *pnext_rot, temp_squares)) {
-        pnext_pos->Y += 1;
-      } else {
-        // Can't move further down
-        break;
-      }
-    }
+    // Instant drop: the ghost already holds the landing row for this column and rotation
+    pnext_pos->Y = ghost_pos.Y;
   }
 }
 //========================================================================
-void Draw() {                               // Draw 120x240 in the center
+void Draw() {                               // Push only the cells that changed since the last call
+  uint8_t want[Width][Height];
+  for (int i = 0; i < Width; ++i) for (int j = 0; j < Height; ++j) want[i][j] = tetris->screen[i][j];
+  if (!gameover) {
+    for (int i = 0; i < 4; ++i) {
+      int x = ghost_pos.X + block.square[rot][i].X;
+      int y = ghost_pos.Y + block.square[rot][i].Y;
+      if (want[x][y] == 0) want[x][y] = GHOST + block.color;
+    }
+  }
   for (int i = 0; i < Width; ++i) for (int j = 0; j < Height; ++j)
-   for (int k = 0; k < Length; ++k) for (int l = 0; l < Length; ++l)
-    backBuffer[j * Length + l][i * Length + k] = BlockImage[screen[i][j]][k][l];
-    tft.pushImage(12, 20, 110, 220,*backBuffer);
+    if (tetris->drawn[i][j] != want[i][j]) DrawCell(i, j, want[i][j]);
+}
+//========================================================================
+void DrawCell(int i, int j, int image) {   // Push one block of the 110x220 game area
+  tft.pushImage(12 + i * Length, 20 + j * Length, Length, Length, &tetris->BlockImage[image][0][0]);
+  tetris->drawn[i][j] = image;
+}
+//========================================================================
+void UpdateGhost() {                       // Call while the falling block is not in tetris->screen[][]
+  Point squares[4];
+  ghost_pos = pos;
+  Point next = pos;
+  for (++next.Y; GetSquares(block, next, rot, squares); ++next.Y) ghost_pos = next;
 }
 //========================================================================
 void PutStartPos() {
   game_speed=20;
   pos.X = 4; pos.Y = 1;
-  block = blocks[random(7)];
-  rot = random(block.numRotate);
+  block = blocks[replayRandom(7)];
+  rot = replayRandom(block.numRotate);
+  spawn_cnt++;
 }
 //========================================================================
 bool GetSquares(Block block, Point pos, int rot, Point* squares) {
@@ -177,7 +210,7 @@ bool GetSquares(Block block, Point pos, int rot, Point* squares) {
     p.X = pos.X + block.square[rot][i].X;
     p.Y = pos.Y + block.square[rot][i].Y;
     overlap |= p.X < 0 || p.X >= Width || p.Y < 0 || p.Y >= 
-      Height || screen[p.X][p.Y] != 0;
+      Height || tetris->screen[p.X][p.Y] != 0;
     squares[i] = p;
   }
   return !overlap;
@@ -185,17 +218,18 @@ bool GetSquares(Block block, Point pos, int rot, Point* squares) {
 //========================================================================
 
 void GameOver() {
-  // Update high scores if current score qualifies
-  if (score > tetrisScores[4].score) {
-    // Insert the new score into the list
-    insertNewScore(tetrisScores, score);
-    // Write updated scores to SD card
-    writeScoresToSD("/tetris_scores.txt", tetrisScores);
+  // Update high scores if current score qualifies (demo games don't count)
+  if (!tetrisBotActive) {
+    recordGamePlayed(LEADERBOARD_TETRIS, score);
+    if (scoreQualifies(LEADERBOARD_TETRIS, score)) {
+      // Insert the new score into the list and save it
+      insertNewScore(LEADERBOARD_TETRIS, score);
+    }
   }
 
   for (int i = 0; i < Width; ++i)
     for (int j = 0; j < Height; ++j)
-      if (screen[i][j] != 0) screen[i][j] = 4;
+      if (tetris->screen[i][j] != 0) tetris->screen[i][j] = 4;
   gameover = true;
 }
 //========================================================================
@@ -252,7 +286,7 @@ void KeyPadLoop() {
 void DeleteLine() {
   for (int j = 0; j < Height; ++j) {
     bool Delete = true;
-    for (int i = 0; i < Width; ++i) if (screen[i][j] == 0) Delete = false;
+    for (int i = 0; i < Width; ++i) if (tetris->screen[i][j] == 0) Delete = false;
     if (Delete)
     {
        score++;
@@ -269,7 +303,7 @@ void DeleteLine() {
               {
     for (int i = 0; i < Width; ++i)
     {
-      screen[i][k] = screen[i][k - 1];
+      tetris->screen[i][k] = tetris->screen[i][k - 1];
     }
   }
 }}}
@@ -278,19 +312,21 @@ void ReviseScreen(Point next_pos, int next_rot) {
   if (!started) return;
   Point next_squares[4];
   // Remove the block from the screen
-  for (int i = 0; i < 4; ++i) screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = 0;
+  for (int i = 0; i < 4; ++i) tetris->screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = 0;
 
   if (GetSquares(block, next_pos, next_rot, next_squares)) {
     // Move the block to the new position
-    for (int i = 0; i < 4; ++i){
-      screen[next_squares[i].X][next_squares[i].Y] = block.color;
-    }
+    bool shifted = next_pos.X != pos.X || next_rot != rot;
     pos = next_pos;
     rot = next_rot;
+    if (shifted) UpdateGhost();         // Falling alone never moves the landing spot
+    for (int i = 0; i < 4; ++i){
+      tetris->screen[next_squares[i].X][next_squares[i].Y] = block.color;
+    }
   } else {
     // Can't move the block to next_pos, so put it back to current position
     for (int i = 0; i < 4; ++i)
-      screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
+      tetris->screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
 
     // If the attempted move was down, and we can't move further down
     if (next_pos.Y != pos.Y || but_UP) {
@@ -300,8 +336,10 @@ void ReviseScreen(Point next_pos, int next_rot) {
       Point temp_squares[4];
       if (!GetSquares(block, pos, rot, temp_squares)) {
         for (int i = 0; i < 4; ++i)
-          screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
+          tetris->screen[pos.X + block.square[rot][i].X][pos.Y + block.square[rot][i].Y] = block.color;
         GameOver();
+      } else {
+        UpdateGhost();                  // New block and possibly cleared lines
       }
     }
   }
@@ -309,9 +347,16 @@ void ReviseScreen(Point next_pos, int next_rot) {
 }
 //========================================================================
 void make_block( int n , uint16_t color ){            // Make Block color       
-  for ( int i =0 ; i < 12; i++ ) for ( int j =0 ; j < 12; j++ ){
-    BlockImage[n][i][j] = color;                           // Block color
-    if ( i == 0 || j == 0 ) BlockImage[n][i][j] = 0;       // TFT_BLACK Line
+  for ( int i =0 ; i < Length; i++ ) for ( int j =0 ; j < Length; j++ ){
+    tetris->BlockImage[n][i][j] = color;                           // Block color
+    if ( i == 0 || j == 0 ) tetris->BlockImage[n][i][j] = 0;       // TFT_BLACK Line
   } 
 }
+//========================================================================
+void make_ghost( int n , uint16_t color ){            // Make outlined ghost of block n
+  for ( int i =0 ; i < Length; i++ ) for ( int j =0 ; j < Length; j++ ){
+    bool edge = i == 1 || j == 1 || i == Length - 1 || j == Length - 1;
+    tetris->BlockImage[GHOST + n][i][j] = (i > 0 && j > 0 && edge) ? color : 0;
+  }
+}
 //========================================================================
\ No newline at end of file
@@ -0,0 +1,152 @@
+// TetrisBot.cpp
+
+#include "TetrisBot.h"
+#include "Tetris.h"
+#include "ControllerInput.h"
+
+bool tetrisBotActive = false;
+
+// Heuristic weights (x1000) for the field left behind by a placement
+const long WEIGHT_HEIGHT = -510;     // sum of column heights
+const long WEIGHT_LINES = 760;       // completed lines
+const long WEIGHT_HOLES = -357;      // empty cells with a filled cell above
+const long WEIGHT_BUMPINESS = -184;  // sum of height differences of neighbouring columns
+
+// Placement chosen for the falling block
+unsigned long plannedSpawn = 0;
+int targetX = 0;
+int targetRot = 0;
+bool botPressed = false;
+
+// Function prototypes (private to this file)
+void planPlacement();
+bool botFits(uint8_t field[Width][Height], int x, int y, int r);
+long scoreField(uint8_t field[Width][Height]);
+
+void tetrisBotStart() {
+  tetrisBotActive = true;
+  plannedSpawn = 0;
+  botPressed = false;
+  applyButtonMask(1, BUTTONS_RELEASED);
+}
+
+void tetrisBotUpdate() {
+  if (!tetrisBotActive) return;
+
+  // Release after every press so the next press is a new edge
+  if (botPressed) {
+    botPressed = false;
+    applyButtonMask(1, BUTTONS_RELEASED);
+    return;
+  }
+
+  int button;
+  if (gameover || !started) {
+    button = BUTTON_DOWN;   // Starts or restarts the game
+  } else {
+    if (plannedSpawn != spawn_cnt) planPlacement();
+    Point squares[4];
+    Point below = pos;
+    below.Y++;
+
+    if (rot != targetRot) {
+      button = BUTTON_A;
+    } else if (pos.X > targetX) {
+      button = BUTTON_LEFT;
+    } else if (pos.X < targetX) {
+      button = BUTTON_RIGHT;
+    } else if (GetSquares(block, below, rot, squares)) {
+      button = BUTTON_UP;     // Hard drop
+    } else {
+      button = BUTTON_DOWN;   // Already landed, lock on the next tick
+    }
+  }
+
+  applyButtonMask(1, BUTTON_PRESSED(button));
+  botPressed = true;
+}
+
+// Try every rotation and column of the falling block and keep the best scoring one
+void planPlacement() {
+  uint8_t field[Width][Height];
+  uint8_t trial[Width][Height];
+
+  // The falling block may already be in tetris->screen[][]; plan on the field without it
+  for (int i = 0; i < Width; ++i) for (int j = 0; j < Height; ++j) field[i][j] = tetris->screen[i][j];
+  for (int i = 0; i < 4; ++i) {
+    int x = pos.X + block.square[rot][i].X;
+    int y = pos.Y + block.square[rot][i].Y;
+    if (x >= 0 && x < Width && y >= 0 && y < Height) field[x][y] = 0;
+  }
+
+  long bestScore = 0;
+  bool found = false;
+  targetX = pos.X;
+  targetRot = rot;
+
+  for (int r = 0; r < block.numRotate; ++r) {
+    if (!botFits(field, pos.X, pos.Y, r)) continue;
+    for (int x = -2; x < Width + 2; ++x) {
+      // The block has to be able to slide there at its current height
+      bool reachable = true;
+      for (int step = pos.X; step != x && reachable; step += (x > pos.X) ? 1 : -1) {
+        reachable = botFits(field, step, pos.Y, r);
+      }
+      if (!reachable || !botFits(field, x, pos.Y, r)) continue;
+
+      int y = pos.Y;
+      while (botFits(field, x, y + 1, r)) y++;
+
+      memcpy(trial, field, sizeof(trial));
+      for (int i = 0; i < 4; ++i) trial[x + block.square[r][i].X][y + block.square[r][i].Y] = block.color;
+
+      long value = scoreField(trial);
+      if (!found || value > bestScore) {
+        found = true;
+        bestScore = value;
+        targetX = x;
+        targetRot = r;
+      }
+    }
+  }
+  plannedSpawn = spawn_cnt;
+}
+
+bool botFits(uint8_t field[Width][Height], int x, int y, int r) {
+  for (int i = 0; i < 4; ++i) {
+    int px = x + block.square[r][i].X;
+    int py = y + block.square[r][i].Y;
+    if (px < 0 || px >= Width || py < 0 || py >= Height || field[px][py] != 0) return false;
+  }
+  return true;
+}
+
+// Clears completed lines in field and rates what is left
+long scoreField(uint8_t field[Width][Height]) {
+  int lines = 0;
+  for (int j = Height - 1; j >= 0; --j) {
+    bool full = true;
+    for (int i = 0; i < Width && full; ++i) full = field[i][j] != 0;
+    if (!full) continue;
+    lines++;
+    for (int k = j; k >= 1; --k)
+      for (int i = 0; i < Width; ++i) field[i][k] = field[i][k - 1];
+    for (int i = 0; i < Width; ++i) field[i][0] = 0;
+    j++;  // Check the row that moved down into j
+  }
+
+  long height = 0, holes = 0, bumpiness = 0;
+  int prevHeight = 0;
+  for (int i = 0; i < Width; ++i) {
+    int top = 0;
+    while (top < Height && field[i][top] == 0) top++;
+    int columnHeight = Height - top;
+    for (int j = top + 1; j < Height; ++j)
+      if (field[i][j] == 0) holes++;
+    height += columnHeight;
+    if (i > 0) bumpiness += abs(columnHeight - prevHeight);
+    prevHeight = columnHeight;
+  }
+
+  return WEIGHT_HEIGHT * height + WEIGHT_LINES * lines + WEIGHT_HOLES * holes + WEIGHT_BUMPINESS * bumpiness;
+}
@@ -0,0 +1,25 @@
+// TetrisBot.h
+
+#ifndef TETRIS_BOT_H
+#define TETRIS_BOT_H
+
+#include <Arduino.h>
+
+// True while the autoplayer owns controller 1 (attract mode, benchmarks)
+extern bool tetrisBotActive;
+
+/**
+ * @brief Hands controller 1 to the autoplayer. Call after tetrisSetup().
+ */
+void tetrisBotStart();
+
+/**
+ * @brief Picks the next button packet for the falling block and applies it to controller 1.
+ *
+ * Call once before every tetrisLoop(). A new placement is searched only when a block spawns;
+ * every other tick just steers towards it, alternating press and release so the game's
+ * edge detection in KeyPadLoop() sees each press.
+ */
+void tetrisBotUpdate();
+
+#endif // TETRIS_BOT_H
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Golden-frame check for the host build.
+
+Each case in golden/<name>/ has a controller script, a directory standing in for the SD card
+(holding a replay.log for the games) and frames.txt, the hash of every frame the run draws.
+A check runs the case and stops at the first frame that differs, saving it as
+<name>_failure.png in the current directory.
+
+  host/golden.py build/arcade_host             check every case
+  host/golden.py build/arcade_host pong menu   check some
+  host/golden.py --update build/arcade_host    rewrite frames.txt after an intended change
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+GOLDEN_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'golden')
+
+# Simulated seconds per case, enough to cover the whole recording
+CASES = {
+    'menu': 8,
+    'tetris': 12,
+    'snake': 14,
+    'pong': 12,
+    'chess': 30,
+}
+
+
+def run_case(program, name, update):
+    case_dir = os.path.join(GOLDEN_DIR, name)
+    frames = os.path.join(case_dir, 'frames.txt')
+    with tempfile.TemporaryDirectory() as work:
+        # The run may write scores or stats, keep the case itself untouched
+        sd = os.path.join(work, 'sd')
+        shutil.copytree(os.path.join(case_dir, 'sd'), sd)
+        command = [program, '--seconds', str(CASES[name]), '--script', os.path.join(case_dir, 'script.txt'),
+                   '--sd', sd]
+        if update:
+            command += ['--golden-write', frames]
+        else:
+            command += ['--golden', frames, '--golden-png', '%s_failure.png' % name]
+        result = subprocess.run(command, stderr=subprocess.PIPE, universal_newlines=True)
+
+    report = [line for line in result.stderr.splitlines() if line.startswith('golden:')]
+    print('%-8s %s' % (name, report[0][len('golden: '):] if report else 'no result'))
+    for line in report[1:]:
+        print('         ' + line[len('golden: '):])
+    return result.returncode == 0
+
+
+def main(argv):
+    update = '--update' in argv
+    argv = [arg for arg in argv if arg != '--update']
+    # -h, --help and any mistyped option land here too, as does a program that isn't built
+    if (not argv or any(arg.startswith('-') for arg in argv) or not os.path.isfile(argv[0])
+            or any(name not in CASES for name in argv[1:])):
+        sys.stderr.write(__doc__)
+        return 2
+
+    program = os.path.abspath(argv[0])
+    names = argv[1:] or list(CASES)
+    failed = [name for name in names if not run_case(program, name, update)]
+    if failed:
+        print('FAILED: %s' % ' '.join(failed))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
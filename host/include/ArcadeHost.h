@@ -0,0 +1,116 @@
+// ArcadeHost.h
+//
+// Controls for the host build that have no device equivalent: the virtual clock, the
+// simulated panel and the scripted controllers. Sketch code never includes this.
+
+#ifndef ARCADE_HOST_H
+#define ARCADE_HOST_H
+
+#include <stdint.h>
+
+// Physical panel of the T-Display-S3, rotation 0
+const int HOST_PANEL_WIDTH = 170;
+const int HOST_PANEL_HEIGHT = 320;
+
+// Display bus model: fixed cost per draw call (address window) plus 2 bytes per pixel
+const uint32_t HOST_BUS_BYTES_PER_SECOND = 20000000;
+const uint32_t HOST_BUS_CALL_BYTES = 11;
+
+// Virtual time charged for every millis()/micros() call, so polling loops still make progress
+const uint32_t HOST_POLL_MICROS = 1;
+
+// Running totals of what the sketch has sent to the display
+struct HostDisplayStats {
+  uint64_t drawCalls;     // TFT_eSPI drawing calls made by the sketch, each print() character counted
+  uint64_t transactions;  // address windows set on the bus, several per call for text and circles
+  uint64_t pixels;        // pixels written on screen
+  uint64_t busBytes;      // bytes clocked out, commands and pixel data
+};
+
+// Thrown out of the clock when the session's time is up
+struct HostStop {};
+
+// Thrown by esp_restart(), main() restarts the program like the chip would
+struct HostRestart {};
+
+/**
+ * @brief Microseconds since the host session started, across restarts.
+ */
+uint64_t hostSessionMicros();
+
+/**
+ * @brief Moves the virtual clock forward, delivering scripted input that falls due on the way.
+ *
+ * Throws HostStop once the session length set with hostSetStopMicros() is reached.
+ */
+void hostAdvanceMicros(uint64_t us);
+
+/**
+ * @brief Starts the session clock at a given time, with millis() counting from zero again.
+ */
+void hostBootAt(uint64_t sessionMicros);
+
+/**
+ * @brief Sets the session time at which the clock throws HostStop.
+ */
+void hostSetStopMicros(uint64_t sessionMicros);
+
+/**
+ * @brief Sets the value analogRead() returns, which the sketch uses as its random seed.
+ */
+void hostSetAnalogSeed(int value);
+
+/**
+ * @brief Returns the panel contents, HOST_PANEL_WIDTH x HOST_PANEL_HEIGHT RGB565 pixels.
+ */
+const uint16_t* hostFramebuffer();
+
+/**
+ * @brief Returns the display counters since the program started.
+ */
+const HostDisplayStats& hostDisplayStats();
+
+/**
+ * @brief Writes the panel contents to a binary PPM image.
+ * @return true on success.
+ */
+bool hostWritePpm(const char* path);
+
+/**
+ * @brief Writes the panel contents to a PNG image.
+ * @return true on success.
+ */
+bool hostWritePng(const char* path);
+
+/**
+ * @brief Hashes the panel contents (64-bit FNV-1a over the RGB565 pixels).
+ */
+uint64_t hostFramebufferHash();
+
+/**
+ * @brief Points the SD stand-in at a host directory.
+ */
+void hostSetSdRoot(const char* path);
+
+/**
+ * @brief Queues a controller packet to arrive at a session time.
+ * @param controller 1 or 2.
+ * @param mask Packet value, a cleared bit per pressed button (see ControllerInput.h).
+ */
+void hostScheduleButtons(uint64_t sessionMicros, int controller, uint16_t mask);
+
+/**
+ * @brief Reads a controller script: lines of "<ms> <controller> <buttons>".
+ *
+ * Buttons are names joined with '+' (LEFT, RIGHT, UP, DOWN, X, Y, A, B, M, P, PAUSE) or '-'
+ * for all released. '#' starts a comment.
+ * @return false if the file can't be read or a line is malformed.
+ */
+bool hostLoadScript(const char* path);
+
+/**
+ * @brief Delivers a controller packet through the registered ESP-NOW callback right now.
+ */
+void hostSendButtons(int controller, uint16_t mask);
+
+#endif // ARCADE_HOST_H
@@ -0,0 +1,135 @@
+// Arduino.h (host stand-in)
+//
+// The subset of the ESP32 Arduino core that BootMenu uses, backed by the virtual clock in
+// ArcadeHost.h. Serial goes to stderr so tools can keep stdout for their own output.
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <esp_system.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define LOW 0x0
+#define HIGH 0x1
+
+#define DEC 10
+#define HEX 16
+
+// Default SPI chip select of the ESP32-S3
+static const uint8_t SS = 10;
+
+// Arduino String on top of std::string, only what the sketch uses
+class String {
+ public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  String(int value, unsigned char base = DEC);
+  String(unsigned int value, unsigned char base = DEC);
+  String(long value, unsigned char base = DEC);
+  String(unsigned long value, unsigned char base = DEC);
+
+  unsigned int length() const { return s_.size(); }
+  const char* c_str() const { return s_.c_str(); }
+  char operator[](unsigned int index) const { return index < s_.size() ? s_[index] : 0; }
+
+  String& operator+=(const String& other) { s_ += other.s_; return *this; }
+  String& operator+=(const char* other) { s_ += other; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s_); }
+  bool operator==(const String& other) const { return s_ == other.s_; }
+  bool operator!=(const String& other) const { return s_ != other.s_; }
+
+  void toCharArray(char* buffer, unsigned int size) const;
+  int indexOf(char c) const;
+  String substring(unsigned int from, unsigned int to = ~0u) const;
+  long toInt() const { return atol(s_.c_str()); }
+  void trim();
+
+ private:
+  std::string s_;
+};
+
+// Text output shared by Serial, files and the display
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t println() { return write((uint8_t)'\n'); }
+  template <typename T> size_t println(const T& value) { size_t n = print(value); return n + println(); }
+  template <typename T> size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long /* baud */) {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+// Heap figures. The host has no ESP32 heap, these are fixed values in the range of a
+// T-Display-S3 running the menu.
+class EspClass {
+ public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+// RTC memory outlives esp_restart() on the chip; the host restarts with fresh globals
+#define RTC_NOINIT_ATTR
+
+// Timing, on the virtual clock
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Random numbers, the same generator on every host so replays match
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+// Pins do nothing, analogRead returns the seed set with --seed
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+
+#endif // ARDUINO_H
@@ -0,0 +1,44 @@
+// SD.h (host stand-in)
+//
+// The card is a directory on the host, set with --sd.
+
+#ifndef SD_H
+#define SD_H
+
+#include <Arduino.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+class File : public Print {
+ public:
+  File(FILE* file = NULL) : file_(file) {}
+  explicit operator bool() const { return file_ != NULL; }
+
+  int available();
+  int read();
+  size_t read(uint8_t* buffer, size_t size);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  size_t size();
+  void close();
+
+ private:
+  FILE* file_;
+};
+
+class SDFS {
+ public:
+  bool begin(uint8_t ssPin = SS);
+  void end() {}
+  File open(const char* path, const char* mode = FILE_READ);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* pathFrom, const char* pathTo);
+};
+
+extern SDFS SD;
+
+#endif // SD_H
@@ -0,0 +1,10 @@
+// SPI.h (host stand-in)
+//
+// Nothing to do, the display and SD stand-ins need no bus.
+
+#ifndef SPI_H
+#define SPI_H
+
+#include <Arduino.h>
+
+#endif // SPI_H
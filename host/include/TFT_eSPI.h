@@ -0,0 +1,96 @@
+// TFT_eSPI.h (host stand-in)
+//
+// Draws into an in-memory copy of the T-Display-S3 panel (170x320, RGB565, see
+// hostFramebuffer()) and charges the virtual clock for the bytes each call would push over
+// the display bus. Text uses placeholder glyphs with the metrics of TFT_eSPI font 1
+// (6x8 cells times the text size), so layouts match the device but letters are not legible.
+
+#ifndef TFT_ESPI_H
+#define TFT_ESPI_H
+
+#include <Arduino.h>
+
+// Panel size in rotation 0, from the T-Display-S3 user setup
+#define TFT_WIDTH  170
+#define TFT_HEIGHT 320
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+
+// Text reference points for drawString()
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+class TFT_eSPI : public Print {
+ public:
+  TFT_eSPI();
+
+  void init();
+  void setRotation(uint8_t rotation);
+  int16_t width() const;
+  int16_t height() const;
+
+  void fillScreen(uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+  void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+  void setSwapBytes(bool swap);
+
+  void setTextSize(uint8_t size);
+  void setTextColor(uint16_t color);
+  void setTextColor(uint16_t color, uint16_t background);
+  void setTextDatum(uint8_t datum);
+  void setCursor(int16_t x, int16_t y);
+  int16_t textWidth(const char* string);
+  int16_t textWidth(const String& string);
+  int16_t fontHeight();
+  int16_t fontHeight(int16_t font);
+  int16_t drawString(const String& string, int32_t x, int32_t y);
+  int16_t drawString(const String& string, int32_t x, int32_t y, uint8_t font);
+  int16_t drawCentreString(const String& string, int32_t x, int32_t y, uint8_t font);
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+ private:
+  void plot(int32_t x, int32_t y, uint16_t color);
+  void span(int32_t x, int32_t y, int32_t w, uint16_t color);
+  void drawGlyph(int32_t x, int32_t y, char c);
+
+  uint8_t rotation_;
+  bool swapBytes_;
+  uint8_t textSize_;
+  uint16_t textColor_;
+  uint16_t textBackground_;
+  uint8_t textDatum_;
+  int32_t cursorX_;
+  int32_t cursorY_;
+};
+
+#endif // TFT_ESPI_H
@@ -0,0 +1,19 @@
+// WiFi.h (host stand-in)
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+
+#define WIFI_STA 1
+
+// Station mode is all ESP-NOW needs, there is no radio to configure
+class WiFiClass {
+ public:
+  bool mode(int /* mode */) { return true; }
+  bool disconnect() { return true; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // WIFI_H
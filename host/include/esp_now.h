@@ -0,0 +1,19 @@
+// esp_now.h (host stand-in)
+//
+// The receive callback is fed from the controller script, see hostSendButtons().
+
+#ifndef ESP_NOW_H
+#define ESP_NOW_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef void (*esp_now_recv_cb_t)(const uint8_t* mac, const uint8_t* data, int len);
+
+esp_err_t esp_now_init();
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb);
+
+#endif // ESP_NOW_H
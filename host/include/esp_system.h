@@ -0,0 +1,11 @@
+// esp_system.h (host stand-in)
+
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+/**
+ * @brief Restarts the host program the way the chip would reboot, see ArcadeHost.h.
+ */
+[[noreturn]] void esp_restart();
+
+#endif // ESP_SYSTEM_H
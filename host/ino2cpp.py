@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Turns an Arduino sketch folder into one C++ file, the way the Arduino builder does.
+
+The main .ino (named after the folder) comes first, the other .ino files follow in
+alphabetical order, and prototypes for every function they define are inserted before the
+first function definition. #line directives keep compiler messages pointing at the .ino files.
+
+usage: ino2cpp.py SKETCH_DIR OUTPUT
+"""
+
+import os
+import re
+import sys
+
+# A function definition starting in column 0: return type, name, parameters, opening brace
+FUNCTION = re.compile(r'^([A-Za-z_][\w:<>*& ]*?[\w*&])\s+\**(\w+)\s*\(([^;{)]*)\)\s*\{', re.M)
+KEYWORDS = {'if', 'while', 'for', 'switch', 'return', 'else'}
+
+
+def sketch_files(sketch_dir):
+    main = os.path.basename(os.path.normpath(sketch_dir)) + '.ino'
+    others = sorted(f for f in os.listdir(sketch_dir) if f.endswith('.ino') and f != main)
+    return [os.path.join(sketch_dir, f) for f in [main] + others]
+
+
+def prototypes(source):
+    found = []
+    for match in FUNCTION.finditer(source):
+        if match.group(2) in KEYWORDS:
+            continue
+        found.append(match.group(0).rstrip('{').strip() + ';')
+    return found
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    sketch_dir, output = sys.argv[1], sys.argv[2]
+
+    lines = ['// Generated by ino2cpp.py from %s, do not edit' % os.path.abspath(sketch_dir),
+             '#include <Arduino.h>']
+    declarations = []
+    inserted = False
+    for path in sketch_files(sketch_dir):
+        with open(path) as f:
+            source = f.read()
+        declarations += prototypes(source)
+    for path in sketch_files(sketch_dir):
+        with open(path) as f:
+            source = f.read()
+        name = os.path.abspath(path)
+        first = FUNCTION.search(source)
+        if not inserted and first:
+            line = source.count('\n', 0, first.start()) + 1
+            lines.append('#line 1 "%s"' % name)
+            lines.append(source[:first.start()].rstrip('\n'))
+            lines += declarations
+            lines.append('#line %d "%s"' % (line, name))
+            lines.append(source[first.start():])
+            inserted = True
+        else:
+            lines.append('#line 1 "%s"' % name)
+            lines.append(source)
+
+    text = '\n'.join(lines) + '\n'
+    # Leave the file alone when nothing changed so the build doesn't recompile it
+    if os.path.exists(output):
+        with open(output) as f:
+            if f.read() == text:
+                return
+    with open(output, 'w') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""RAM and flash used by each module, from a GNU linker map.
+
+The ESP32 build writes BootMenu.ino.map next to the firmware; the host build writes
+arcade_host.map. Sizes are summed per object file from the input sections the linker placed,
+so a module's static arrays show up against it whichever scene is running.
+
+  arduino-cli compile -b esp32:esp32:esp32s3 --build-path build/device BootMenu
+  host/memory_map.py build/device/BootMenu.ino.map          per module, largest RAM first
+  host/memory_map.py --symbols 20 build/arcade_host.map      and the 20 largest variables
+  host/memory_map.py --discarded 10 MAP                      and the 10 largest unused ones
+
+The .ino files are compiled as one translation unit, so Tetris.ino's globals are listed under
+BootMenu.ino. Variables and functions only get their own line with --symbols when they have
+their own section (-fdata-sections, -ffunction-sections), which both builds use.
+--discarded lists what --gc-sections dropped because nothing referenced it.
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+# Output section, e.g. ".dram0.bss      0x3fc8a000     0x1234", or just its name when that is long
+OUTPUT_SECTION = re.compile(r'^(\.\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+))?\s*$')
+# Input section, " .bss.snakeX    0x3fc8a000      0x190 path/Snake.cpp.o", the name alone when long
+INPUT_SECTION = re.compile(r'^ (\.\S+|COMMON)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+))?\s*$')
+# Second line of a long input section name
+CONTINUATION = re.compile(r'^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+)$')
+
+COLUMNS = ['data', 'bss', 'iram', 'flash', 'psram']
+
+
+def classify(section):
+    """Where an output section lives: a column of the report, or None when it takes no memory."""
+    if 'dummy' in section or section.startswith(('.debug', '.comment', '.note', '.xt', '.stab')):
+        return None
+    if section.startswith('.ext_ram'):
+        return 'psram'
+    if 'bss' in section or 'noinit' in section:
+        return 'bss'
+    if section.startswith(('.iram', '.rtc.text')):
+        return 'iram'
+    if 'data' in section and 'rodata' not in section:
+        return 'data'
+    return 'flash'
+
+
+def module_name(path, by_archive):
+    """Object file without its folder and suffix; archive members as archive(member)."""
+    match = re.match(r'(.*)\((.*)\)$', path)
+    if match:
+        archive = os.path.basename(match.group(1))
+        if by_archive:
+            return archive
+        path = '%s(%s)' % (archive, match.group(2))
+    else:
+        path = os.path.basename(path)
+    return re.sub(r'(\.(c|cc|cpp|S))?\.o(bj)?(\))?$', r'\4', path)
+
+
+def parse(path):
+    """Returns ([(output section, input section, size, object file)], [(input section, size, file)])."""
+    placed = []
+    discarded = []
+    part = None
+    output = None
+    pending = None    # Input section name waiting for its address line
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if line.startswith('Discarded input sections'):
+                part = 'discarded'
+                continue
+            if line.startswith('Memory Configuration'):
+                part = None
+                continue
+            if line.startswith('Linker script and memory map'):
+                part = 'map'
+                continue
+            if part is None:
+                continue
+
+            if pending is not None:
+                match = CONTINUATION.match(line)
+                name, pending = pending, None
+                if match:
+                    entry = (name, int(match.group(2), 16), match.group(3).strip())
+                    if part == 'discarded':
+                        discarded.append(entry)
+                    elif output is not None:
+                        placed.append((output,) + entry)
+                    continue
+
+            match = INPUT_SECTION.match(line)
+            if match:
+                if match.group(4) is None:
+                    pending = match.group(1)
+                else:
+                    entry = (match.group(1), int(match.group(3), 16), match.group(4).strip())
+                    if part == 'discarded':
+                        discarded.append(entry)
+                    elif output is not None:
+                        placed.append((output,) + entry)
+                continue
+
+            if part == 'map':
+                match = OUTPUT_SECTION.match(line)
+                if match:
+                    # Sections the linker doesn't load have address 0, e.g. the debug information.
+                    # A long name has its address on the next line, classify() sorts those out.
+                    address = match.group(2)
+                    output = match.group(1) if address is None or int(address, 16) != 0 else None
+    return placed, discarded
+
+
+def symbol_name(section):
+    """Variable or function behind a per-symbol input section, .bss.snakeX -> snakeX."""
+    match = re.match(r'\.(?:s?bss|s?data|rodata|text|literal|iram1|dram1|noinit)(?:\.[0-9]+)?\.(.+)$', section)
+    return match.group(1) if match else None
+
+
+def demangle(names):
+    """C++ names made readable when a c++filt is around, unchanged otherwise."""
+    tool = shutil.which('c++filt') or shutil.which('xtensa-esp32s3-elf-c++filt')
+    if tool is None or not names:
+        return names
+    result = subprocess.run([tool], input='\n'.join(names), stdout=subprocess.PIPE, universal_newlines=True)
+    lines = result.stdout.splitlines()
+    return lines if len(lines) == len(names) else names
+
+
+def print_symbols(title, entries, count):
+    names = demangle([symbol_name(section) or section for section, _, _ in entries[:count]])
+    print()
+    print(title)
+    for name, (_, size, path) in zip(names, entries[:count]):
+        print('  %8d  %-40s %s' % (size, name[:40], module_name(path, False)))
+
+
+def main(argv):
+    options = {'--symbols': 0, '--discarded': 0}
+    by_archive = '--by-archive' in argv
+    argv = [arg for arg in argv if arg != '--by-archive']
+    paths = []
+    i = 0
+    while i < len(argv):
+        if argv[i] in options and i + 1 < len(argv):
+            options[argv[i]] = int(argv[i + 1])
+            i += 2
+        else:
+            paths.append(argv[i])
+            i += 1
+    if len(paths) != 1 or paths[0].startswith('-'):
+        sys.stderr.write(__doc__)
+        return 2
+
+    placed, discarded = parse(paths[0])
+    modules = {}
+    ram = []
+    for output, section, size, path in placed:
+        column = classify(output)
+        if column is None or size == 0 or path.startswith('*'):
+            continue
+        totals = modules.setdefault(module_name(path, by_archive), dict.fromkeys(COLUMNS, 0))
+        totals[column] += size
+        if column in ('data', 'bss', 'psram'):
+            ram.append((section, size, path))
+
+    # RAM holds data, bss and IRAM code; flash holds code, constants and the initial data
+    rows = []
+    for name, totals in modules.items():
+        rows.append((name, totals['data'] + totals['bss'] + totals['iram'],
+                     totals['flash'] + totals['data'] + totals['iram'], totals))
+    rows.sort(key=lambda row: (-row[1], -row[2], row[0]))
+
+    print('%-36s %8s %8s %8s %8s %8s %8s' % ('module', 'RAM', 'data', 'bss', 'IRAM', 'flash', 'PSRAM'))
+    total = dict.fromkeys(COLUMNS, 0)
+    total_ram = total_flash = 0
+    for name, ram_bytes, flash_bytes, totals in rows:
+        print('%-36s %8d %8d %8d %8d %8d %8d' % (name[:36], ram_bytes, totals['data'], totals['bss'],
+                                               totals['iram'], flash_bytes, totals['psram']))
+        for column in COLUMNS:
+            total[column] += totals[column]
+        total_ram += ram_bytes
+        total_flash += flash_bytes
+    print('%-36s %8d %8d %8d %8d %8d %8d' % ('total', total_ram, total['data'], total['bss'], total['iram'],
+                                           total_flash, total['psram']))
+
+    if options['--symbols']:
+        ram.sort(key=lambda entry: -entry[1])
+        print_symbols('Largest variables in RAM:', ram, options['--symbols'])
+    if options['--discarded']:
+        discarded.sort(key=lambda entry: -entry[1])
+        print_symbols('Largest sections dropped as unused:', discarded, options['--discarded'])
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
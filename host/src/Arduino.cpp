@@ -0,0 +1,195 @@
+// Arduino.cpp (host stand-in)
+//
+// String, Print and Serial, the virtual clock behind millis()/micros()/delay(), the random
+// generator and esp_restart().
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include "ArcadeHost.h"
+
+HardwareSerial Serial;
+
+// Host state is static so it can't clash with sketch globals
+
+static uint64_t sessionMicros = 0;        // Virtual time since the session started
+static uint64_t bootMicros = 0;           // Session time of the last (re)start, millis() counts from here
+static uint64_t stopMicros = UINT64_MAX;  // Session time at which HostStop is thrown
+static uint64_t randomState = 1;
+static int analogSeed = 1;
+
+// Scripted controller packets, defined in Network.cpp
+void hostDeliverDueInput(uint64_t upTo);
+
+// =============================================================================================================
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+  char buffer[34];
+  snprintf(buffer, sizeof(buffer), base == HEX ? "%lx" : "%ld", value);
+  s_ = buffer;
+}
+
+String::String(unsigned long value, unsigned char base) {
+  char buffer[34];
+  snprintf(buffer, sizeof(buffer), base == HEX ? "%lx" : "%lu", value);
+  s_ = buffer;
+}
+
+void String::toCharArray(char* buffer, unsigned int size) const {
+  if (size == 0) return;
+  size_t length = std::min<size_t>(size - 1, s_.size());
+  memcpy(buffer, s_.data(), length);
+  buffer[length] = '\0';
+}
+
+int String::indexOf(char c) const {
+  size_t position = s_.find(c);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > s_.size()) return String();
+  return String(s_.substr(from, to == ~0u ? std::string::npos : to - from));
+}
+
+void String::trim() {
+  size_t end = s_.find_last_not_of(" \t\r\n");
+  size_t start = s_.find_first_not_of(" \t\r\n");
+  s_ = start == std::string::npos ? "" : s_.substr(start, end - start + 1);
+}
+
+// =============================================================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::print(long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return print(buffer);
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  return write((const uint8_t*)buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fputc(c, stderr) == EOF ? 0 : 1;
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getHeapSize() {
+  return 327680;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return 262144;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return 262144;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return 110592;
+}
+
+// =============================================================================================================
+
+uint64_t hostSessionMicros() {
+  return sessionMicros;
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  uint64_t target = sessionMicros + us;
+  hostDeliverDueInput(target);
+  sessionMicros = std::max(sessionMicros, target);
+  if (sessionMicros >= stopMicros) {
+    throw HostStop();
+  }
+}
+
+void hostBootAt(uint64_t at) {
+  sessionMicros = at;
+  bootMicros = at;
+}
+
+void hostSetStopMicros(uint64_t at) {
+  stopMicros = at;
+}
+
+void hostSetAnalogSeed(int value) {
+  analogSeed = value;
+}
+
+unsigned long millis() {
+  hostAdvanceMicros(HOST_POLL_MICROS);
+  return (sessionMicros - bootMicros) / 1000;
+}
+
+unsigned long micros() {
+  hostAdvanceMicros(HOST_POLL_MICROS);
+  return sessionMicros - bootMicros;
+}
+
+void delay(unsigned long ms) {
+  hostAdvanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvanceMicros(us);
+}
+
+void yield() {
+  hostAdvanceMicros(HOST_POLL_MICROS);
+}
+
+// =============================================================================================================
+
+// 64-bit LCG (Knuth's MMIX constants), the upper bits are good enough for games
+void randomSeed(unsigned long seed) {
+  if (seed != 0) randomState = seed;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  randomState = randomState * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (long)((randomState >> 33) % (uint64_t)howbig);
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {}
+
+int analogRead(uint8_t pin) {
+  return analogSeed;
+}
+
+void esp_restart() {
+  throw HostRestart();
+}
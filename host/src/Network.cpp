@@ -0,0 +1,129 @@
+// Network.cpp (host stand-in)
+//
+// Wi-Fi does nothing. ESP-NOW keeps the receive callback so scripted controller packets can
+// arrive through the same path as on the device, each controller with a fixed MAC.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <map>
+#include "ArcadeHost.h"
+
+WiFiClass WiFi;
+
+static esp_now_recv_cb_t receiveCallback = NULL;
+static bool controllersIntroduced = false;
+static bool delivering = false;
+
+// Pending packets by session time, in script order for equal times
+struct ScriptedPacket {
+  int controller;
+  uint16_t mask;
+};
+static std::multimap<uint64_t, ScriptedPacket> script;
+
+// Button names as in ControllerInput.h, bit = position
+static const char* const BUTTON_NAMES[] = {"LEFT", "RIGHT", "UP", "DOWN", "X", "Y", "A", "B", "M", "P", "PAUSE"};
+static const int BUTTON_NAME_COUNT = sizeof(BUTTON_NAMES) / sizeof(BUTTON_NAMES[0]);
+static const uint16_t ALL_RELEASED = (1 << BUTTON_NAME_COUNT) - 1;
+
+// =============================================================================================================
+
+esp_err_t esp_now_init() {
+  return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+  receiveCallback = cb;
+  controllersIntroduced = false;
+  return ESP_OK;
+}
+
+void hostSendButtons(int controller, uint16_t mask) {
+  if (receiveCallback == NULL) return;
+
+  // The sketch hands out controller slots in the order MACs first appear. Announce both
+  // controllers with everything released before the first real packet so scripts can
+  // rely on controller 1 and 2.
+  if (!controllersIntroduced) {
+    controllersIntroduced = true;
+    hostSendButtons(1, ALL_RELEASED);
+    hostSendButtons(2, ALL_RELEASED);
+  }
+
+  const uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, (uint8_t)controller};
+  uint8_t packet[2] = {(uint8_t)mask, (uint8_t)(mask >> 8)};
+  receiveCallback(mac, packet, sizeof(packet));
+}
+
+void hostScheduleButtons(uint64_t sessionMicros, int controller, uint16_t mask) {
+  script.insert(std::make_pair(sessionMicros, ScriptedPacket{controller, mask}));
+}
+
+// Called by the clock before it moves to upTo. Packets arrive at their own time, like an
+// interrupt between two instructions of the game loop.
+void hostDeliverDueInput(uint64_t upTo) {
+  if (delivering) return; // The callback reads millis() itself
+  delivering = true;
+  while (!script.empty() && script.begin()->first <= upTo) {
+    std::multimap<uint64_t, ScriptedPacket>::iterator next = script.begin();
+    if (next->first > hostSessionMicros()) {
+      hostAdvanceMicros(next->first - hostSessionMicros());
+    }
+    ScriptedPacket packet = next->second;
+    script.erase(next);
+    hostSendButtons(packet.controller, packet.mask);
+  }
+  delivering = false;
+}
+
+// =============================================================================================================
+
+// Parses "A+LEFT" or "-" into a packet value
+static bool parseButtons(const char* text, uint16_t* mask) {
+  *mask = ALL_RELEASED;
+  if (strcmp(text, "-") == 0) return true;
+
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%s", text);
+  for (char* name = strtok(buffer, "+"); name != NULL; name = strtok(NULL, "+")) {
+    int bit = 0;
+    while (bit < BUTTON_NAME_COUNT && strcmp(name, BUTTON_NAMES[bit]) != 0) bit++;
+    if (bit == BUTTON_NAME_COUNT) return false;
+    *mask &= ~(1 << bit);
+  }
+  return true;
+}
+
+bool hostLoadScript(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "Can't open script %s\n", path);
+    return false;
+  }
+
+  char line[256];
+  int lineNumber = 0;
+  bool ok = true;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    lineNumber++;
+    char* comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+
+    unsigned long long ms;
+    int controller;
+    char buttons[64];
+    int fields = sscanf(line, "%llu %d %63s", &ms, &controller, buttons);
+    if (fields <= 0) continue; // Blank line
+
+    uint16_t mask;
+    if (fields != 3 || (controller != 1 && controller != 2) || !parseButtons(buttons, &mask)) {
+      fprintf(stderr, "%s:%d: expected \"<ms> <1|2> <buttons>\"\n", path, lineNumber);
+      ok = false;
+      break;
+    }
+    hostScheduleButtons(ms * 1000, controller, mask);
+  }
+  fclose(file);
+  return ok;
+}
@@ -0,0 +1,84 @@
+// SD.cpp (host stand-in)
+//
+// Card paths map onto a host directory ("sd" by default, --sd to change).
+
+#include <SD.h>
+#include <string>
+#include <sys/stat.h>
+#include "ArcadeHost.h"
+
+SDFS SD;
+
+static std::string sdRoot = "sd";
+
+static std::string hostPath(const char* path) {
+  return sdRoot + (path[0] == '/' ? "" : "/") + path;
+}
+
+void hostSetSdRoot(const char* path) {
+  sdRoot = path;
+}
+
+// =============================================================================================================
+
+bool SDFS::begin(uint8_t ssPin) {
+  // No directory means no card in the slot
+  struct stat info;
+  return stat(sdRoot.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+File SDFS::open(const char* path, const char* mode) {
+  const char* hostMode = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : "rb";
+  return File(fopen(hostPath(path).c_str(), hostMode));
+}
+
+bool SDFS::exists(const char* path) {
+  struct stat info;
+  return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool SDFS::remove(const char* path) {
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool SDFS::rename(const char* pathFrom, const char* pathTo) {
+  // FAT refuses to rename over an existing file, keep that behaviour
+  if (exists(pathTo)) return false;
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+// =============================================================================================================
+
+int File::available() {
+  long position = ftell(file_);
+  return (int)(size() - position);
+}
+
+int File::read() {
+  return fgetc(file_);
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  return fread(buffer, 1, size, file_);
+}
+
+size_t File::write(uint8_t c) {
+  return fputc(c, file_) == EOF ? 0 : 1;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  return fwrite(buffer, 1, size, file_);
+}
+
+size_t File::size() {
+  long position = ftell(file_);
+  fseek(file_, 0, SEEK_END);
+  long end = ftell(file_);
+  fseek(file_, position, SEEK_SET);
+  return end;
+}
+
+void File::close() {
+  if (file_ != NULL) fclose(file_);
+  file_ = NULL;
+}
@@ -0,0 +1,419 @@
+// TFT_eSPI.cpp (host stand-in)
+
+#include <TFT_eSPI.h>
+#include <vector>
+#include "ArcadeHost.h"
+
+static uint16_t framebuffer[HOST_PANEL_WIDTH * HOST_PANEL_HEIGHT];
+
+// Roughly the reset and sleep-out waits of TFT_eSPI's ST7789 init sequence
+static const uint32_t INIT_MICROS = 150000;
+
+// Font 1 cell, before scaling by the text size
+static const int GLYPH_WIDTH = 6;
+static const int GLYPH_HEIGHT = 8;
+
+static HostDisplayStats displayStats;
+
+// Calls the sketch makes, not the ones the stand-in makes to itself (fillScreen -> fillRect)
+static int drawDepth = 0;
+
+struct DrawCall {
+  DrawCall() {
+    if (drawDepth++ == 0) displayStats.drawCalls++;
+  }
+  ~DrawCall() {
+    drawDepth--;
+  }
+};
+
+// Charges the virtual clock for draw calls that would each set an address window and then
+// stream pixels at 2 bytes each
+static void chargeBus(uint32_t calls, uint32_t pixels) {
+  uint64_t bytes = (uint64_t)calls * HOST_BUS_CALL_BYTES + (uint64_t)pixels * 2;
+  displayStats.transactions += calls;
+  displayStats.pixels += pixels;
+  displayStats.busBytes += bytes;
+  hostAdvanceMicros(bytes * 1000000 / HOST_BUS_BYTES_PER_SECOND);
+}
+
+const HostDisplayStats& hostDisplayStats() {
+  return displayStats;
+}
+
+const uint16_t* hostFramebuffer() {
+  return framebuffer;
+}
+
+static void toRgb(uint16_t c, uint8_t* rgb) {
+  rgb[0] = (c >> 11) * 255 / 31;
+  rgb[1] = ((c >> 5) & 0x3F) * 255 / 63;
+  rgb[2] = (c & 0x1F) * 255 / 31;
+}
+
+bool hostWritePpm(const char* path) {
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) return false;
+  fprintf(file, "P6\n%d %d\n255\n", HOST_PANEL_WIDTH, HOST_PANEL_HEIGHT);
+  for (int i = 0; i < HOST_PANEL_WIDTH * HOST_PANEL_HEIGHT; i++) {
+    uint8_t rgb[3];
+    toRgb(framebuffer[i], rgb);
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  return fclose(file) == 0;
+}
+
+uint64_t hostFramebufferHash() {
+  // FNV-1a over the pixels as stored
+  uint64_t hash = 14695981039346656037ull;
+  const uint8_t* bytes = (const uint8_t*)framebuffer;
+  for (size_t i = 0; i < sizeof(framebuffer); i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+  }
+  return ~crc;
+}
+
+static void putBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+  for (int shift = 24; shift >= 0; shift -= 8) out.push_back((uint8_t)(value >> shift));
+}
+
+static void writeChunk(FILE* file, const char* type, const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> chunk;
+  putBigEndian(chunk, data.size());
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  putBigEndian(chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+  fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+// Uncompressed ("stored") deflate blocks keep this short, the files are only for looking at
+bool hostWritePng(const char* path) {
+  std::vector<uint8_t> raw;
+  for (int y = 0; y < HOST_PANEL_HEIGHT; y++) {
+    raw.push_back(0); // No filter
+    for (int x = 0; x < HOST_PANEL_WIDTH; x++) {
+      uint8_t rgb[3];
+      toRgb(framebuffer[y * HOST_PANEL_WIDTH + x], rgb);
+      raw.insert(raw.end(), rgb, rgb + 3);
+    }
+  }
+
+  std::vector<uint8_t> zlib = {0x78, 0x01};
+  uint32_t a = 1, b = 0;
+  for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+    size_t length = std::min<size_t>(65535, raw.size() - offset);
+    zlib.push_back(offset + length == raw.size() ? 1 : 0);
+    zlib.push_back(length & 0xFF);
+    zlib.push_back(length >> 8);
+    zlib.push_back(~length & 0xFF);
+    zlib.push_back((~length >> 8) & 0xFF);
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    for (size_t i = offset; i < offset + length; i++) {
+      a = (a + raw[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+  }
+  putBigEndian(zlib, (b << 16) | a);
+
+  std::vector<uint8_t> header;
+  putBigEndian(header, HOST_PANEL_WIDTH);
+  putBigEndian(header, HOST_PANEL_HEIGHT);
+  header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB
+
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) return false;
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  fwrite(signature, 1, sizeof(signature), file);
+  writeChunk(file, "IHDR", header);
+  writeChunk(file, "IDAT", zlib);
+  writeChunk(file, "IEND", std::vector<uint8_t>());
+  return fclose(file) == 0;
+}
+
+// =============================================================================================================
+
+TFT_eSPI::TFT_eSPI()
+    : rotation_(0), swapBytes_(false), textSize_(1), textColor_(TFT_WHITE), textBackground_(TFT_WHITE),
+      textDatum_(TL_DATUM), cursorX_(0), cursorY_(0) {}
+
+void TFT_eSPI::init() {
+  hostAdvanceMicros(INIT_MICROS);
+}
+
+// Rotations 4-7 are the same as 0-3 on the ST7789
+void TFT_eSPI::setRotation(uint8_t rotation) {
+  rotation_ = rotation & 3;
+}
+
+int16_t TFT_eSPI::width() const {
+  return (rotation_ & 1) ? HOST_PANEL_HEIGHT : HOST_PANEL_WIDTH;
+}
+
+int16_t TFT_eSPI::height() const {
+  return (rotation_ & 1) ? HOST_PANEL_WIDTH : HOST_PANEL_HEIGHT;
+}
+
+// Writes one pixel in rotated coordinates, clipped to the screen
+void TFT_eSPI::plot(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= width() || y >= height()) return;
+  int32_t panelX, panelY;
+  switch (rotation_) {
+    case 0: panelX = x; panelY = y; break;
+    case 1: panelX = HOST_PANEL_WIDTH - 1 - y; panelY = x; break;
+    case 2: panelX = HOST_PANEL_WIDTH - 1 - x; panelY = HOST_PANEL_HEIGHT - 1 - y; break;
+    default: panelX = y; panelY = HOST_PANEL_HEIGHT - 1 - x; break;
+  }
+  framebuffer[panelY * HOST_PANEL_WIDTH + panelX] = color;
+}
+
+// Horizontal run of one call, charged for the part that is on screen
+void TFT_eSPI::span(int32_t x, int32_t y, int32_t w, uint16_t color) {
+  if (y < 0 || y >= height()) return;
+  int32_t from = max<int32_t>(x, 0);
+  int32_t to = min<int32_t>(x + w, width());
+  if (from >= to) return;
+  for (int32_t i = from; i < to; i++) plot(i, y, color);
+  chargeBus(1, to - from);
+}
+
+// =============================================================================================================
+
+void TFT_eSPI::fillScreen(uint32_t color) {
+  DrawCall call;
+  fillRect(0, 0, width(), height(), color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  DrawCall call;
+  int32_t left = max<int32_t>(x, 0), right = min<int32_t>(x + w, width());
+  int32_t top = max<int32_t>(y, 0), bottom = min<int32_t>(y + h, height());
+  if (left >= right || top >= bottom) return;
+  for (int32_t j = top; j < bottom; j++) {
+    for (int32_t i = left; i < right; i++) plot(i, j, color);
+  }
+  chargeBus(1, (right - left) * (bottom - top));
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  DrawCall call;
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  DrawCall call;
+  fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  DrawCall call;
+  fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  DrawCall call;
+  fillRect(x, y, 1, 1, color);
+}
+
+// Bresenham, charged as one call per straight run like TFT_eSPI's drawLine
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  DrawCall call;
+  int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int32_t error = dx + dy;
+  uint32_t pixels = 0, runs = 1;
+  while (true) {
+    plot(x0, y0, color);
+    pixels++;
+    if (x0 == x1 && y0 == y1) break;
+    int32_t e2 = 2 * error;
+    bool stepX = e2 >= dy, stepY = e2 <= dx;
+    if (stepX && stepY) runs++;
+    if (stepX) { error += dy; x0 += sx; }
+    if (stepY) { error += dx; y0 += sy; }
+  }
+  chargeBus(runs, pixels);
+}
+
+// One horizontal run per row, as TFT_eSPI draws it
+void TFT_eSPI::fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+  DrawCall call;
+  for (int32_t j = -r; j <= r; j++) {
+    int32_t half = (int32_t)sqrt((double)(r * r - j * j));
+    span(x - half, y + j, 2 * half + 1, color);
+  }
+}
+
+void TFT_eSPI::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color) {
+  DrawCall call;
+  int32_t top = min(min(y0, y1), y2), bottom = max(max(y0, y1), y2);
+  int32_t xs[3] = {x0, x1, x2}, ys[3] = {y0, y1, y2};
+  for (int32_t y = top; y <= bottom; y++) {
+    // Where the row crosses the three edges, the span lies between the outermost crossings
+    int32_t from = INT32_MAX, to = INT32_MIN;
+    for (int e = 0; e < 3; e++) {
+      int32_t ax = xs[e], ay = ys[e], bx = xs[(e + 1) % 3], by = ys[(e + 1) % 3];
+      if ((y < ay && y < by) || (y > ay && y > by)) continue;
+      int32_t x = ay == by ? min(ax, bx) : ax + (bx - ax) * (y - ay) / (by - ay);
+      int32_t xEnd = ay == by ? max(ax, bx) : x;
+      from = min(from, x);
+      to = max(to, xEnd);
+    }
+    if (from <= to) span(from, y, to - from + 1, color);
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  DrawCall call;
+  uint32_t pixels = 0;
+  for (int32_t j = 0; j < h; j++) {
+    for (int32_t i = 0; i < w; i++) {
+      uint16_t color = data[j * w + i];
+      // Without swapping the bytes go out in memory order, i.e. little-endian
+      if (!swapBytes_) color = (color >> 8) | (color << 8);
+      if (x + i >= 0 && y + j >= 0 && x + i < width() && y + j < height()) pixels++;
+      plot(x + i, y + j, color);
+    }
+  }
+  if (pixels > 0) chargeBus(1, pixels);
+}
+
+void TFT_eSPI::setSwapBytes(bool swap) {
+  swapBytes_ = swap;
+}
+
+// =============================================================================================================
+
+void TFT_eSPI::setTextSize(uint8_t size) {
+  textSize_ = size > 0 ? size : 1;
+}
+
+// Background equal to the text colour means transparent, as in TFT_eSPI
+void TFT_eSPI::setTextColor(uint16_t color) {
+  textColor_ = color;
+  textBackground_ = color;
+}
+
+void TFT_eSPI::setTextColor(uint16_t color, uint16_t background) {
+  textColor_ = color;
+  textBackground_ = background;
+}
+
+void TFT_eSPI::setTextDatum(uint8_t datum) {
+  textDatum_ = datum;
+}
+
+void TFT_eSPI::setCursor(int16_t x, int16_t y) {
+  cursorX_ = x;
+  cursorY_ = y;
+}
+
+int16_t TFT_eSPI::textWidth(const char* string) {
+  return GLYPH_WIDTH * textSize_ * strlen(string);
+}
+
+int16_t TFT_eSPI::textWidth(const String& string) {
+  return textWidth(string.c_str());
+}
+
+int16_t TFT_eSPI::fontHeight() {
+  return GLYPH_HEIGHT * textSize_;
+}
+
+int16_t TFT_eSPI::fontHeight(int16_t font) {
+  return fontHeight();
+}
+
+// Placeholder glyph: 5x7 dots picked from the character code, so different text gives
+// different pixels. Transparent text costs a call per dot like TFT_eSPI's font 1, with a
+// background the whole cell goes out in one.
+void TFT_eSPI::drawGlyph(int32_t x, int32_t y, char c) {
+  const int size = textSize_;
+  bool opaque = textBackground_ != textColor_;
+  if (opaque) {
+    for (int32_t j = 0; j < GLYPH_HEIGHT * size; j++) {
+      for (int32_t i = 0; i < GLYPH_WIDTH * size; i++) plot(x + i, y + j, textBackground_);
+    }
+  }
+
+  uint32_t dots = 0;
+  if (c != ' ') {
+    uint32_t bits = (uint32_t)(uint8_t)c * 2654435761u;
+    for (int col = 0; col < 5; col++) {
+      uint8_t column = ((bits >> (col * 6)) & 0x7F) | 0x41; // Top and bottom dots always set
+      for (int row = 0; row < 7; row++) {
+        if (!(column & (1 << row))) continue;
+        for (int32_t j = 0; j < size; j++) {
+          for (int32_t i = 0; i < size; i++) plot(x + col * size + i, y + row * size + j, textColor_);
+        }
+        dots++;
+      }
+    }
+  }
+
+  if (opaque) {
+    chargeBus(1, GLYPH_WIDTH * GLYPH_HEIGHT * size * size);
+  } else if (dots > 0) {
+    chargeBus(dots, dots * size * size);
+  }
+}
+
+int16_t TFT_eSPI::drawString(const String& string, int32_t x, int32_t y) {
+  return drawString(string, x, y, 1);
+}
+
+// Every font is drawn with font 1 metrics
+int16_t TFT_eSPI::drawString(const String& string, int32_t x, int32_t y, uint8_t font) {
+  DrawCall call;
+  int16_t w = textWidth(string);
+  int16_t h = GLYPH_HEIGHT * textSize_;
+  switch (textDatum_ % 3) {
+    case 1: x -= w / 2; break;
+    case 2: x -= w; break;
+  }
+  switch (textDatum_ / 3) {
+    case 1: y -= h / 2; break;
+    case 2: y -= h; break;
+  }
+  for (unsigned int i = 0; i < string.length(); i++) {
+    drawGlyph(x + i * GLYPH_WIDTH * textSize_, y, string[i]);
+  }
+  return w;
+}
+
+int16_t TFT_eSPI::drawCentreString(const String& string, int32_t x, int32_t y, uint8_t font) {
+  DrawCall call;
+  uint8_t datum = textDatum_;
+  textDatum_ = TC_DATUM;
+  int16_t w = drawString(string, x, y, font);
+  textDatum_ = datum;
+  return w;
+}
+
+// print() and friends, wrapping at the right edge like TFT_eSPI
+size_t TFT_eSPI::write(uint8_t c) {
+  DrawCall call;
+  if (c == '\n') {
+    cursorX_ = 0;
+    cursorY_ += GLYPH_HEIGHT * textSize_;
+  } else if (c != '\r') {
+    if (cursorX_ + GLYPH_WIDTH * textSize_ > width()) {
+      cursorX_ = 0;
+      cursorY_ += GLYPH_HEIGHT * textSize_;
+    }
+    drawGlyph(cursorX_, cursorY_, c);
+    cursorX_ += GLYPH_WIDTH * textSize_;
+  }
+  return 1;
+}
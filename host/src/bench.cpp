@@ -0,0 +1,352 @@
+// bench.cpp (host benchmark)
+//
+// Plays each game headless for a fixed stretch of virtual time with scripted input and
+// reports frame rate and display traffic as JSON on stdout, so runs before and after a
+// change can be compared by a script. Sketch output (Serial) goes to stderr.
+//
+// Built with DISPLAY_STATS, each game also lists its busiest tft call sites.
+//
+// Each call of the game's loop function ends with frameWait(), as in the launch loops, so
+// games run at their own frame period. A frame is a call that drew something. Calls that only
+// polled input still cost HOST_POLL_MICROS, so a game waiting for input can't stall the clock.
+// frame_us and slack_us are the scheduler's averages over all calls (see Frame.h).
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "ArcadeHost.h"
+#include "ControllerInput.h"
+#include "Tetris.h"
+#include "TetrisBot.h"
+#include "Pong.h"
+#include "Snake.h"
+#include "SnakeBot.h"
+#include "Chess.h"
+#include "Render.h"
+#include "Frame.h"
+#include "Replay.h"
+#include "Scene.h"
+
+// Defined by the sketch
+extern int pongMode;
+extern Paddle player1;
+extern Ball ball;
+extern int player1Score, player2Score;
+extern int swapInt;
+
+struct BenchGame {
+  const char* name;
+  void (*setup)();
+  void (*frame)();  // Feeds the scripted input, then runs the game's loop once
+};
+
+struct BenchResult {
+  const char* name;
+  uint64_t loops;
+  uint64_t frames;
+  uint64_t micros;
+  uint64_t frameMicros;   // Summed over the scheduler's frames
+  uint64_t slackMicros;
+  uint64_t lateFrames;
+  HostDisplayStats display;
+#ifdef DISPLAY_STATS
+  std::vector<DisplayCallSite> sites;
+#endif
+};
+
+// Call sites listed per game, most bus bytes first
+const int BENCH_REPORT_SITES = 8;
+
+// Function prototypes (private to this file)
+void benchTetrisSetup();
+void benchTetrisFrame();
+void benchSnakeSetup();
+void benchSnakeFrame();
+void benchPongSetup();
+void benchPongFrame();
+void benchChessSetup();
+void benchChessFrame();
+void releaseControllers();
+BenchResult runGame(const BenchGame& game, double seconds, int seed);
+void printResults(const std::vector<BenchResult>& results, double seconds, int seed);
+void printSites(const BenchResult& result);
+
+const BenchGame BENCH_GAMES[] = {
+  {"tetris", benchTetrisSetup, benchTetrisFrame},
+  {"snake", benchSnakeSetup, benchSnakeFrame},
+  {"pong", benchPongSetup, benchPongFrame},
+  {"chess", benchChessSetup, benchChessFrame},
+};
+const int BENCH_GAME_COUNT = sizeof(BENCH_GAMES) / sizeof(BENCH_GAMES[0]);
+
+// =============================================================================================================
+// Scripted players
+
+// The autoplayers from attract mode; both press their own restart button at game over
+void benchTetrisSetup() {
+  tetrisSetup();
+  tetrisBotStart();
+}
+
+void benchTetrisFrame() {
+  tetrisBotUpdate();
+  tetrisLoop();
+}
+
+void benchSnakeSetup() {
+  snakeSetup();
+  snakeBotStart();
+}
+
+// The snake bot steers from inside snakeLoop
+void benchSnakeFrame() {
+  snakeLoop();
+}
+
+// Player 1 follows the ball against the hardest CPU, a new match starts after each game over
+void benchPongSetup() {
+  pongMode = CPU_LEVELS;
+  pongSetup();
+}
+
+void benchPongFrame() {
+  if (player1Score == 10 || player2Score == 10) {
+    tft.fillScreen(TFT_BLACK);
+    pongSetup();
+  }
+
+  int ballCentre = FIX_TO_INT(ball.y) + BALL_SIZE / 2;
+  int paddleCentre = FIX_TO_INT(player1.y) + PADDLE_HEIGHT / 2;
+  if (ballCentre < paddleCentre - PADDLE_HEIGHT / 4) {
+    applyButtonMask(1, BUTTON_PRESSED(BUTTON_UP));
+  } else if (ballCentre > paddleCentre + PADDLE_HEIGHT / 4) {
+    applyButtonMask(1, BUTTON_PRESSED(BUTTON_DOWN));
+  } else {
+    applyButtonMask(1, BUTTONS_RELEASED);
+  }
+  pongLoop();
+}
+
+// Fool's mate over and over: the cursor walks to each square, one press per frame with a
+// release in between, on the controller of the side to move. Kept off the scoreboard like the bots.
+struct ChessMove {
+  int fromX, fromY, toX, toY;
+};
+
+const ChessMove FOOLS_MATE[] = {
+  {5, 6, 5, 5},  // f3
+  {4, 1, 4, 3},  // e5
+  {6, 6, 6, 4},  // g4
+  {3, 0, 7, 4},  // Qh4#
+};
+const int FOOLS_MATE_PLIES = sizeof(FOOLS_MATE) / sizeof(FOOLS_MATE[0]);
+
+int chessScriptStep = 0;     // Two per move, the square to pick up then the square to drop on
+bool chessButtonHeld = false;
+
+void benchChessSetup() {
+  chessDemo = true;
+  chessSetup();
+  drawBoard();
+  chessScriptStep = 0;
+  chessButtonHeld = false;
+}
+
+void benchChessFrame() {
+  if (chessButtonHeld) {
+    releaseControllers();
+    chessButtonHeld = false;
+  } else {
+    const ChessMove& move = FOOLS_MATE[(chessScriptStep / 2) % FOOLS_MATE_PLIES];
+    int targetX = (chessScriptStep % 2 == 0) ? move.fromX : move.toX;
+    int targetY = (chessScriptStep % 2 == 0) ? move.fromY : move.toY;
+
+    int button;
+    if (cursorX < targetX) button = BUTTON_RIGHT;
+    else if (cursorX > targetX) button = BUTTON_LEFT;
+    else if (cursorY < targetY) button = BUTTON_DOWN;
+    else if (cursorY > targetY) button = BUTTON_UP;
+    else {
+      button = BUTTON_A;
+      chessScriptStep++;
+    }
+    applyButtonMask(swapInt == 0 ? 1 : 2, BUTTON_PRESSED(button));
+    chessButtonHeld = true;
+  }
+  chessLoop();
+}
+
+// =============================================================================================================
+
+void releaseControllers() {
+  applyButtonMask(1, BUTTONS_RELEASED);
+  applyButtonMask(2, BUTTONS_RELEASED);
+}
+
+// Starts the game the way its launch function does, then runs it for the given virtual time.
+// Only frames that finished inside the time count.
+BenchResult runGame(const BenchGame& game, double seconds, int seed) {
+  BenchResult result = {};
+  result.name = game.name;
+
+  releaseControllers();
+  replayRandomSeed(seed);
+  hostSetStopMicros(UINT64_MAX);
+  tft.setRotation(4);
+  tft.setTextSize(2);
+  tft.fillScreen(TFT_BLACK);
+  sceneBegin(game.name);
+  game.setup();
+  framePause(0); // Draws the setup and starts the frames afresh
+
+  uint64_t start = hostSessionMicros();
+  HostDisplayStats before = hostDisplayStats();
+  hostSetStopMicros(start + (uint64_t)(seconds * 1e6));
+#ifdef DISPLAY_STATS
+  displayStatsReset();
+#endif
+  try {
+    while (true) {
+      uint64_t drawCalls = hostDisplayStats().drawCalls;
+      game.frame();
+      frameWait();
+      hostAdvanceMicros(HOST_POLL_MICROS);
+
+      const FrameStats& frame = frameStats();
+      result.frameMicros += frame.frameMicros;
+      result.slackMicros += frame.slackMicros;
+      if (frame.slackMicros == 0) result.lateFrames++;
+
+      const HostDisplayStats& now = hostDisplayStats();
+      result.loops++;
+      if (now.drawCalls != drawCalls) result.frames++;
+      result.micros = hostSessionMicros() - start;
+      result.display.drawCalls = now.drawCalls - before.drawCalls;
+      result.display.transactions = now.transactions - before.transactions;
+      result.display.pixels = now.pixels - before.pixels;
+      result.display.busBytes = now.busBytes - before.busBytes;
+    }
+  } catch (const HostStop&) {
+    // Time is up
+  }
+
+#ifdef DISPLAY_STATS
+  int count;
+  const DisplayCallSite* sites = displayStatsSites(&count);
+  result.sites.assign(sites, sites + count);
+#endif
+  return result;
+}
+
+static double perFrame(uint64_t total, uint64_t frames) {
+  return frames > 0 ? (double)total / frames : 0;
+}
+
+void printResults(const std::vector<BenchResult>& results, double seconds, int seed) {
+  printf("{\n  \"seconds\": %g,\n  \"seed\": %d,\n  \"bus_bytes_per_second_max\": %u,\n  \"games\": [", seconds, seed,
+         HOST_BUS_BYTES_PER_SECOND);
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    double elapsed = r.micros / 1e6;
+    double busPerSecond = elapsed > 0 ? r.display.busBytes / elapsed : 0;
+    printf("%s\n    {\"name\": \"%s\", \"loops\": %llu, \"frames\": %llu, \"fps\": %.2f, "
+           "\"draw_calls_per_frame\": %.1f, \"transactions_per_frame\": %.1f, \"pixels_per_frame\": %.0f, "
+           "\"bus_bytes_per_frame\": %.0f, \"bus_bytes_per_second\": %.0f, \"bus_busy\": %.3f, "
+           "\"frame_us\": %.0f, \"slack_us\": %.0f, \"late_frames\": %llu",
+           i > 0 ? "," : "", r.name, (unsigned long long)r.loops, (unsigned long long)r.frames,
+           elapsed > 0 ? r.frames / elapsed : 0, perFrame(r.display.drawCalls, r.frames),
+           perFrame(r.display.transactions, r.frames), perFrame(r.display.pixels, r.frames),
+           perFrame(r.display.busBytes, r.frames), busPerSecond, busPerSecond / HOST_BUS_BYTES_PER_SECOND,
+           perFrame(r.frameMicros, r.loops), perFrame(r.slackMicros, r.loops), (unsigned long long)r.lateFrames);
+    printSites(r);
+    printf("}");
+  }
+  printf("\n  ]\n}\n");
+}
+
+// Estimates from DisplayStats.h, including the frame that was cut off at the end
+void printSites(const BenchResult& result) {
+#ifdef DISPLAY_STATS
+  std::vector<DisplayCallSite> sites = result.sites;
+  std::sort(sites.begin(), sites.end(), [](const DisplayCallSite& a, const DisplayCallSite& b) {
+    return displayStatsBytes(a.calls, a.pixels) > displayStatsBytes(b.calls, b.pixels);
+  });
+  if (sites.size() > (size_t)BENCH_REPORT_SITES) sites.resize(BENCH_REPORT_SITES);
+
+  printf(",\n     \"call_sites\": [");
+  for (size_t i = 0; i < sites.size(); i++) {
+    const char* name = strrchr(sites[i].file, '/');
+    name = name != NULL ? name + 1 : sites[i].file;
+    printf("%s\n       {\"site\": \"%s:%d\", \"calls_per_frame\": %.2f, \"pixels_per_frame\": %.0f, "
+           "\"bus_bytes_per_frame\": %.0f}",
+           i > 0 ? "," : "", name, sites[i].line, perFrame(sites[i].calls, result.frames),
+           perFrame(sites[i].pixels, result.frames),
+           perFrame(displayStatsBytes(sites[i].calls, sites[i].pixels), result.frames));
+  }
+  printf("]");
+#endif
+}
+
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --seconds N    simulated time per game (default 30)\n"
+          "  --game NAME    tetris, snake, pong or chess, repeatable (default all)\n"
+          "  --seed N       random seed for every game (default 1)\n",
+          program);
+}
+
+int main(int argc, char** argv) {
+  double seconds = 30;
+  int seed = 1;
+  std::vector<const BenchGame*> games;
+
+  for (int i = 1; i < argc; i++) {
+    std::string option = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return 2;
+    }
+    const char* value = argv[++i];
+    if (option == "--seconds") {
+      seconds = atof(value);
+    } else if (option == "--seed") {
+      seed = atoi(value);
+    } else if (option == "--game") {
+      const BenchGame* found = NULL;
+      for (int g = 0; g < BENCH_GAME_COUNT; g++) {
+        if (std::string(value) == BENCH_GAMES[g].name) found = &BENCH_GAMES[g];
+      }
+      if (found == NULL) {
+        usage(argv[0]);
+        return 2;
+      }
+      games.push_back(found);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (games.empty()) {
+    for (int g = 0; g < BENCH_GAME_COUNT; g++) games.push_back(&BENCH_GAMES[g]);
+  }
+
+  // The board as setup() leaves it, without the menu, the controller radio or the SD card.
+  // Storage never starts, so game overs don't stop for name entry.
+  hostBootAt(0);
+  tft.init();
+
+  std::vector<BenchResult> results;
+  try {
+    for (const BenchGame* game : games) {
+      results.push_back(runGame(*game, seconds, seed));
+    }
+  } catch (const HostRestart&) {
+    fprintf(stderr, "A game called esp_restart()\n");
+    return 1;
+  }
+  printResults(results, seconds, seed);
+  return 0;
+}
@@ -0,0 +1,105 @@
+// golden.cpp (host runner)
+
+#include "golden.h"
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "ArcadeHost.h"
+#include "ControllerInput.h"
+
+struct GoldenFrame {
+  uint64_t sessionMillis;
+  uint64_t hash;
+};
+
+static bool recording = false;
+static std::string goldenPath;
+static const char* failurePath = NULL;
+static std::vector<GoldenFrame> expected;
+static FILE* output = NULL;
+static uint32_t frames = 0;
+static uint64_t lastDrawCalls = 0;
+static uint64_t lastHash = 0;
+
+// A frame is a boundary where the picture changed. Polling passes that drew nothing, and
+// redraws of the same picture, don't count, so skipping redundant drawing keeps the hashes.
+static void onFrame() {
+  uint64_t drawCalls = hostDisplayStats().drawCalls;
+  if (drawCalls == lastDrawCalls) return;
+  lastDrawCalls = drawCalls;
+  uint64_t hash = hostFramebufferHash();
+  if (hash == lastHash) return;
+  lastHash = hash;
+
+  GoldenFrame frame = {hostSessionMicros() / 1000, hash};
+  if (recording) {
+    fprintf(output, "%u %llu %016llx\n", frames, (unsigned long long)frame.sessionMillis, (unsigned long long)frame.hash);
+    frames++;
+    return;
+  }
+
+  if (frames >= expected.size()) {
+    fprintf(stderr, "golden: frame %u at %llu ms is past the end of %s (%zu frames)\n", frames,
+            (unsigned long long)frame.sessionMillis, goldenPath.c_str(), expected.size());
+  } else if (frame.hash != expected[frames].hash) {
+    fprintf(stderr, "golden: frame %u at %llu ms differs from %s (expected %016llx at %llu ms, got %016llx)\n", frames,
+            (unsigned long long)frame.sessionMillis, goldenPath.c_str(), (unsigned long long)expected[frames].hash,
+            (unsigned long long)expected[frames].sessionMillis, (unsigned long long)frame.hash);
+  } else {
+    frames++;
+    return;
+  }
+  if (hostWritePng(failurePath)) {
+    fprintf(stderr, "golden: frame saved as %s\n", failurePath);
+  }
+  exit(1);
+}
+
+bool goldenBegin(const char* path, bool record, const char* failurePng, uint32_t framesDone) {
+  recording = record;
+  goldenPath = path;
+  failurePath = failurePng;
+  frames = framesDone;
+
+  if (record) {
+    // Appending after a restart, the frames before it are already in the file
+    output = fopen(path, framesDone > 0 ? "a" : "w");
+    if (output == NULL) {
+      fprintf(stderr, "Can't write %s\n", path);
+      return false;
+    }
+  } else {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+      fprintf(stderr, "Can't read %s\n", path);
+      return false;
+    }
+    unsigned int index;
+    unsigned long long sessionMillis, hash;
+    while (fscanf(file, "%u %llu %llx", &index, &sessionMillis, &hash) == 3) {
+      expected.push_back({sessionMillis, hash});
+    }
+    fclose(file);
+  }
+  setFrameHook(onFrame);
+  return true;
+}
+
+uint32_t goldenFrames() {
+  if (output != NULL) fflush(output);
+  return frames;
+}
+
+bool goldenFinish() {
+  if (recording) {
+    fclose(output);
+    fprintf(stderr, "golden: %u frames written to %s\n", frames, goldenPath.c_str());
+    return true;
+  }
+  if (frames < expected.size()) {
+    fprintf(stderr, "golden: run ended after %u frames, %s has %zu\n", frames, goldenPath.c_str(), expected.size());
+    return false;
+  }
+  fprintf(stderr, "golden: %u frames match %s\n", frames, goldenPath.c_str());
+  return true;
+}
@@ -0,0 +1,33 @@
+// golden.h (host runner)
+//
+// Golden-frame check: the panel is hashed at every frame boundary (updateControllerInput())
+// where the picture changed, and the hashes are written to a file or compared with one. The
+// first frame that differs is reported and saved as a PNG.
+
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <stdint.h>
+
+/**
+ * @brief Starts hashing frames through the sketch's frame hook.
+ * @param path Golden file, lines of "<frame> <session ms> <hash>".
+ * @param record true to write the file, false to compare with it.
+ * @param failurePng Where the first differing frame is saved.
+ * @param framesDone Frames already handled before an esp_restart(), 0 at the start.
+ * @return false if the golden file can't be read or written.
+ */
+bool goldenBegin(const char* path, bool record, const char* failurePng, uint32_t framesDone);
+
+/**
+ * @brief Frames handled so far, carried over an esp_restart().
+ */
+uint32_t goldenFrames();
+
+/**
+ * @brief Ends the check once the session is over.
+ * @return false if the run had fewer frames than the golden file.
+ */
+bool goldenFinish();
+
+#endif // GOLDEN_H
@@ -0,0 +1,142 @@
+// main.cpp (host runner)
+//
+// Runs the BootMenu sketch on the virtual clock: setup() once, then loop() until the
+// session time is up. esp_restart() re-executes the program with the session clock carried
+// over, so every global starts fresh exactly as after a reboot on the device.
+
+#include <Arduino.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "ArcadeHost.h"
+#include "golden.h"
+#include "Render.h"
+
+// Defined by the sketch
+void setup();
+void loop();
+
+struct HostOptions {
+  double seconds = 10;
+  const char* script = NULL;
+  const char* sdRoot = "sd";
+  int seed = 1;
+  const char* dumpPath = NULL;
+  const char* goldenPath = NULL;
+  bool goldenRecord = false;
+  const char* goldenPng = "golden_failure.png";
+  uint64_t startMicros = 0;
+  uint32_t goldenFrames = 0;
+};
+
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --seconds N     simulated session length (default 10)\n"
+          "  --script FILE   controller script, lines of \"<ms> <1|2> <buttons>\"\n"
+          "  --sd DIR        directory standing in for the SD card (default ./sd)\n"
+          "  --seed N        value analogRead() returns, i.e. the random seed (default 1)\n"
+          "  --dump FILE     write the final screen, PNG if FILE ends in .png, else PPM\n"
+          "  --golden FILE   compare a hash of every frame with FILE, stop at the first difference\n"
+          "  --golden-write FILE  write the frame hashes to FILE instead\n"
+          "  --golden-png FILE    where the first differing frame is saved (default golden_failure.png)\n",
+          program);
+}
+
+static bool parseOptions(int argc, char** argv, HostOptions* options) {
+  for (int i = 1; i < argc; i++) {
+    std::string option = argv[i];
+    if (i + 1 >= argc) return false;
+    const char* value = argv[++i];
+    if (option == "--seconds") options->seconds = atof(value);
+    else if (option == "--script") options->script = value;
+    else if (option == "--sd") options->sdRoot = value;
+    else if (option == "--seed") options->seed = atoi(value);
+    else if (option == "--dump") options->dumpPath = value;
+    else if (option == "--golden") options->goldenPath = value;
+    else if (option == "--golden-write") {
+      options->goldenPath = value;
+      options->goldenRecord = true;
+    }
+    else if (option == "--golden-png") options->goldenPng = value;
+    else if (option == "--golden-frames") options->goldenFrames = strtoul(value, NULL, 10); // Set on restart
+    else if (option == "--start-us") options->startMicros = strtoull(value, NULL, 10); // Set on restart
+    else return false;
+  }
+  return true;
+}
+
+// Starts this program again with the same options, continuing the session at the current time
+[[noreturn]] static void restart(int argc, char** argv, const HostOptions& options) {
+  std::vector<std::string> arguments;
+  for (int i = 0; i < argc; i++) {
+    if (std::string(argv[i]) == "--start-us" || std::string(argv[i]) == "--golden-frames") {
+      i++;
+      continue;
+    }
+    arguments.push_back(argv[i]);
+  }
+  arguments.push_back("--start-us");
+  arguments.push_back(std::to_string(hostSessionMicros()));
+  if (options.goldenPath != NULL) {
+    arguments.push_back("--golden-frames");
+    arguments.push_back(std::to_string(goldenFrames()));
+  }
+
+  std::vector<char*> pointers;
+  for (std::string& argument : arguments) pointers.push_back(&argument[0]);
+  pointers.push_back(NULL);
+
+  fflush(stdout);
+  fflush(stderr);
+  execv("/proc/self/exe", pointers.data());
+  perror("execv");
+  exit(1);
+}
+
+int main(int argc, char** argv) {
+  HostOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  hostSetSdRoot(options.sdRoot);
+  hostSetAnalogSeed(options.seed);
+  if (options.script != NULL && !hostLoadScript(options.script)) {
+    return 2;
+  }
+  if (options.goldenPath != NULL &&
+      !goldenBegin(options.goldenPath, options.goldenRecord, options.goldenPng, options.goldenFrames)) {
+    return 2;
+  }
+  hostBootAt(options.startMicros);
+  hostSetStopMicros((uint64_t)(options.seconds * 1e6));
+
+  try {
+    setup();
+    while (true) {
+      loop();
+    }
+  } catch (const HostStop&) {
+    // Session time is up. Draw what the sketch drew since its last frame, as the panel would.
+    hostSetStopMicros(UINT64_MAX);
+    renderSubmit();
+  } catch (const HostRestart&) {
+    Serial.println("esp_restart()");
+    restart(argc, argv, options);
+  }
+
+  if (options.dumpPath != NULL) {
+    std::string path = options.dumpPath;
+    bool png = path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+    if (!(png ? hostWritePng(options.dumpPath) : hostWritePpm(options.dumpPath))) {
+      fprintf(stderr, "Can't write %s\n", options.dumpPath);
+      return 1;
+    }
+  }
+  if (options.goldenPath != NULL && !goldenFinish()) {
+    return 1;
+  }
+  return 0;
+}